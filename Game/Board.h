@@ -4,7 +4,10 @@
 #include <vector>
 
 #include "../Models/Move.h"
+#include "../Models/Position.h"
 #include "../Models/Project_path.h"
+#include "PositionHistory.h"
+#include "TextureCache.h"
 
 #ifdef __APPLE__
 #include <SDL2/SDL.h>
@@ -16,6 +19,18 @@
 
 using namespace std;
 
+// Шаг журнала ходов: простой ход или одно взятие серии. Несколько байт вместо копии всей доски,
+// отмена шага восстанавливает доску по записи.
+struct history_step
+{
+    POS_T x, y;         // Откуда
+    POS_T x2, y2;       // Куда
+    POS_T xb, yb;       // Побитая фигура (-1, если взятия нет)
+    POS_T captured;     // Код побитой фигуры (0, если взятия нет)
+    POS_T beat_series;  // Номер взятия в серии (0 - ход без взятия)
+    bool promoted;      // Фигура стала дамкой на этом шаге
+};
+
 class Board
 {
 public:
@@ -65,26 +80,20 @@ public:
             return 1;
         }
 
-        // Загрузка текстур для игровых элементов
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
-
-        // Проверка успешности загрузки текстур
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
+        // Загрузка всех текстур один раз: дальше отрисовка не обращается к файлам
+        string failed_path;
+        if (!textures.load(ren, textures_path, failed_path))
         {
-            print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
+            print_exception("IMG_Load can't load texture " + failed_path);
             return 1;
         }
 
         // Получение размеров окна рендера и создание начальной матрицы доски
         SDL_GetRendererOutputSize(ren, &W, &H);
+        make_canvas();
         make_start_mtx();
-        rerender();  // Перерисовка доски
+        invalidate_all();
+        present();  // Первый кадр
         return 0;
     }
 
@@ -92,26 +101,18 @@ public:
     void redraw()
     {
         game_results = -1;  // Сброс результатов игры
-        history_mtx.clear();  // Очистка истории ходов
-        history_beat_series.clear();  // Очистка истории серий битья
+        history.clear();  // Очистка журнала ходов
+        positions.clear();  // Очистка истории позиций
         make_start_mtx();  // Создание начальной матрицы
         clear_active();  // Сброс активной клетки
         clear_highlight();  // Сброс выделенных клеток
+        invalidate_all();  // Доска перерисовывается целиком
     }
 
     // Метод для перемещения фигуры
     void move_piece(move_pos turn, const int beat_series = 0)
     {
-        if (turn.xb != -1)
-        {
-            mtx[turn.xb][turn.yb] = 0;  // Удаление фигуры из старой позиции
-        }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);  // Вызов основного метода перемещения
-    }
-
-    // Основной метод перемещения фигуры
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
-    {
+        const POS_T i = turn.x, j = turn.y, i2 = turn.x2, j2 = turn.y2;
         if (mtx[i2][j2])
         {
             throw runtime_error("final position is not empty, can't move");
@@ -121,20 +122,41 @@ public:
             throw runtime_error("begin position is empty, can't move");
         }
 
+        // Первый шаг хода: позиция перед ним попадает в историю позиций.
+        // После взятия или хода простой прежние позиции уже не могут повториться.
+        if (beat_series <= 1)
+            positions.push(position_key(), turn.xb != -1 || mtx[i][j] <= 2);
+
+        history_step step{ i, j, i2, j2, turn.xb, turn.yb, 0, POS_T(beat_series), false };
+        if (turn.xb != -1)
+        {
+            step.captured = mtx[turn.xb][turn.yb];
+            set_cell(turn.xb, turn.yb, 0);  // Удаление побитой фигуры
+        }
+
         // Превращение обычной фигуры в дамку при достижении последней линии
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
-            mtx[i][j] += 2;
+        POS_T piece = mtx[i][j];
+        if ((piece == 1 && i2 == 0) || (piece == 2 && i2 == 7))
+        {
+            piece += 2;
+            step.promoted = true;
+        }
 
-        mtx[i2][j2] = mtx[i][j];  // Перемещение фигуры
-        drop_piece(i, j);  // Удаление фигуры из старой позиции
-        add_history(beat_series);  // Добавление хода в историю
+        set_cell(i2, j2, piece);  // Перемещение фигуры
+        set_cell(i, j, 0);  // Удаление фигуры из старой позиции
+        history.push_back(step);  // Добавление шага в журнал
+    }
+
+    // Метод для перемещения фигуры без взятия
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    {
+        move_piece(move_pos(i, j, i2, j2), beat_series);
     }
 
     // Метод для удаления фигуры с доски
     void drop_piece(const POS_T i, const POS_T j)
     {
-        mtx[i][j] = 0;  // Обнуление позиции
-        rerender();  // Перерисовка доски
+        set_cell(i, j, 0);  // Обнуление позиции, клетка будет перерисована в следующем кадре
     }
 
     // Метод для превращения фигуры в дамку
@@ -144,8 +166,7 @@ public:
         {
             throw runtime_error("can't turn into queen in this position");
         }
-        mtx[i][j] += 2;  // Изменение типа фигуры на дамку
-        rerender();  // Перерисовка доски
+        set_cell(i, j, mtx[i][j] + 2);  // Изменение типа фигуры на дамку
     }
 
     // Метод для получения текущего состояния доски
@@ -161,8 +182,8 @@ public:
         {
             POS_T x = pos.first, y = pos.second;
             is_highlighted_[x][y] = 1;  // Установка флага выделения
+            invalidate(x, y);
         }
-        rerender();  // Перерисовка доски
     }
 
     // Метод для очистки выделений
@@ -170,25 +191,32 @@ public:
     {
         for (POS_T i = 0; i < 8; ++i)
         {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (is_highlighted_[i][j])
+                    invalidate(i, j);  // Перерисовываются только клетки, с которых снято выделение
+            }
             is_highlighted_[i].assign(8, 0);  // Сброс флагов выделения
         }
-        rerender();  // Перерисовка доски
     }
 
     // Метод для установки активной клетки
     void set_active(const POS_T x, const POS_T y)
     {
+        if (active_x != -1)
+            invalidate(active_x, active_y);
         active_x = x;
         active_y = y;
-        rerender();  // Перерисовка доски
+        invalidate(x, y);
     }
 
     // Метод для сброса активной клетки
     void clear_active()
     {
+        if (active_x != -1)
+            invalidate(active_x, active_y);
         active_x = -1;
         active_y = -1;
-        rerender();  // Перерисовка доски
     }
 
     // Метод для проверки, выделена ли клетка
@@ -197,44 +225,119 @@ public:
         return is_highlighted_[x][y];
     }
 
-    // Метод для отмены последнего хода
+    // Метод для отмены последнего хода (серия взятий отменяется целиком)
     void rollback()
     {
-        auto beat_series = max(1, *(history_beat_series.rbegin()));
-        while (beat_series-- && history_mtx.size() > 1)
+        if (history.empty())
+            return;
+        auto beat_series = max(1, int(history.back().beat_series));
+        while (beat_series-- && !history.empty())
         {
-            history_mtx.pop_back();  // Удаление последних ходов из истории
-            history_beat_series.pop_back();
+            undo_step(history.back());  // Шаги журнала отменяются в обратном порядке
+            history.pop_back();
         }
-        mtx = *(history_mtx.rbegin());  // Восстановление предыдущего состояния доски
         clear_highlight();  // Сброс выделений
         clear_active();  // Сброс активной клетки
     }
 
+    // Метод для получения числа шагов в журнале ходов
+    size_t history_size() const
+    {
+        return history.size();
+    }
+
+    // Метод для получения ключа текущей позиции с учетом очереди хода (как Logic::position_key)
+    uint64_t position_key() const
+    {
+        return hash ^ ((positions.size() % 2) ? ZOBRIST.side : 0);
+    }
+
+    // Метод для получения истории позиций перед каждым сделанным ходом (повторения, ходы без взятий)
+    const PositionHistory& position_history() const
+    {
+        return positions;
+    }
+
     // Метод для отображения результата игры
     void show_final(const int res)
     {
         game_results = res;
-        rerender();  // Перерисовка доски
+        invalidate_all();  // Результат рисуется поверх доски
     }
 
     // Метод для обновления размеров окна
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);
-        rerender();  // Перерисовка доски
+        make_canvas();  // Буфер кадра под новый размер
+        invalidate_all();
+    }
+
+    // Метод для восстановления после SDL_RENDER_TARGETS_RESET: содержимое буфера кадра потеряно,
+    // поэтому доска рисуется заново целиком
+    void render_targets_reset()
+    {
+        invalidate_all();
+    }
+
+    // Метод для восстановления после SDL_RENDER_DEVICE_RESET: потеряны все текстуры,
+    // поэтому изображения загружаются заново, а буфер кадра создается и рисуется заново
+    void render_device_reset()
+    {
+        string failed_path;
+        if (!textures.load(ren, textures_path, failed_path))
+            print_exception("IMG_Load can't load texture " + failed_path);
+        make_canvas();
+        invalidate_all();
+    }
+
+    // Метод для вывода накопленных изменений на экран.
+    // Перерисовываются только изменившиеся клетки в буфере кадра, затем буфер выводится одним кадром;
+    // темп задает VSYNC при выводе, а если изменений нет, кадр не выводится вовсе.
+    void present()
+    {
+        if (!full_redraw && !has_dirty)
+            return;
+
+        if (canvas)
+            SDL_SetRenderTarget(ren, canvas);
+        if (full_redraw || !canvas)
+        {
+            draw_all();
+        }
+        else
+        {
+            for (POS_T i = 0; i < 8; ++i)
+            {
+                for (POS_T j = 0; j < 8; ++j)
+                {
+                    if (dirty[i][j])
+                        draw_cell(i, j);
+                }
+            }
+        }
+        if (canvas)
+        {
+            SDL_SetRenderTarget(ren, NULL);
+            SDL_RenderCopy(ren, canvas, NULL, NULL);
+        }
+        SDL_RenderPresent(ren);
+
+        // Сброс отметок изменений
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            dirty[i].assign(8, 0);
+        }
+        has_dirty = false;
+        full_redraw = false;
     }
 
     // Метод для завершения работы с SDL
     void quit()
     {
-        SDL_DestroyTexture(board);
-        SDL_DestroyTexture(w_piece);
-        SDL_DestroyTexture(b_piece);
-        SDL_DestroyTexture(w_queen);
-        SDL_DestroyTexture(b_queen);
-        SDL_DestroyTexture(back);
-        SDL_DestroyTexture(replay);
+        textures.clear();
+        if (canvas)
+            SDL_DestroyTexture(canvas);
         SDL_DestroyRenderer(ren);
         SDL_DestroyWindow(win);
         SDL_Quit();
@@ -247,11 +350,30 @@ public:
     }
 
 private:
-    // Метод для добавления текущего состояния доски в историю
-    void add_history(const int beat_series = 0)
+    // Метод для изменения клетки: обновляет хэш позиции и отмечает клетку к перерисовке
+    void set_cell(const POS_T i, const POS_T j, const POS_T piece)
     {
-        history_mtx.push_back(mtx);
-        history_beat_series.push_back(beat_series);
+        const int sq = sq_index(i, j);
+        if (sq != -1 && mtx[i][j])
+            hash ^= ZOBRIST.piece[mtx[i][j] - 1][sq];
+        if (sq != -1 && piece)
+            hash ^= ZOBRIST.piece[piece - 1][sq];
+        mtx[i][j] = piece;
+        invalidate(i, j);
+    }
+
+    // Метод для отмены шага журнала
+    void undo_step(const history_step& step)
+    {
+        POS_T piece = mtx[step.x2][step.y2];
+        if (step.promoted)
+            piece -= 2;
+        set_cell(step.x2, step.y2, 0);
+        set_cell(step.x, step.y, piece);
+        if (step.xb != -1)
+            set_cell(step.xb, step.yb, step.captured);
+        if (step.beat_series <= 1)
+            positions.pop();
     }
 
     // Метод для создания начальной матрицы доски
@@ -268,97 +390,127 @@ private:
                     mtx[i][j] = 1;  // Расстановка белых фигур
             }
         }
-        add_history();  // Добавление начального состояния в историю
+        hash = bit_position::from_mtx(mtx).hash;  // Хэш начальной позиции
+    }
+
+    // Метод для создания буфера кадра, в котором сохраняется нарисованная доска.
+    // Если рендерер не поддерживает отрисовку в текстуру, каждый кадр рисуется целиком.
+    void make_canvas()
+    {
+        if (canvas)
+            SDL_DestroyTexture(canvas);
+        canvas = nullptr;
+        if (SDL_RenderTargetSupported(ren))
+            canvas = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+    }
+
+    // Метод для отметки клетки, которую нужно перерисовать в следующем кадре
+    void invalidate(const POS_T i, const POS_T j)
+    {
+        dirty[i][j] = 1;
+        has_dirty = true;
     }
 
-    // Метод для перерисовки доски
-    void rerender()
+    // Метод для отметки всей доски к перерисовке
+    void invalidate_all()
+    {
+        full_redraw = true;
+    }
+
+    // Метод для получения прямоугольника клетки в пикселях окна
+    SDL_Rect cell_rect(const POS_T i, const POS_T j) const
+    {
+        return { W * (j + 1) / 10, H * (i + 1) / 10, W * (j + 2) / 10 - W * (j + 1) / 10,
+                 H * (i + 2) / 10 - H * (i + 1) / 10 };
+    }
+
+    // Метод для отрисовки всей доски
+    void draw_all()
     {
         // Очистка рендера и отрисовка доски
         SDL_RenderClear(ren);
-        SDL_RenderCopy(ren, board, NULL, NULL);
-
-        // Отрисовка фигур
-        for (POS_T i = 0; i < 8; ++i)
-        {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                if (!mtx[i][j])
-                    continue;
-
-                int wpos = W * (j + 1) / 10 + W / 120;
-                int hpos = H * (i + 1) / 10 + H / 120;
-                SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
-
-                SDL_Texture* piece_texture;
-                if (mtx[i][j] == 1)
-                    piece_texture = w_piece;
-                else if (mtx[i][j] == 2)
-                    piece_texture = b_piece;
-                else if (mtx[i][j] == 3)
-                    piece_texture = w_queen;
-                else
-                    piece_texture = b_queen;
-
-                SDL_RenderCopy(ren, piece_texture, NULL, &rect);
-            }
-        }
+        textures.draw(ren, Sprite::BOARD, NULL);
 
-        // Отрисовка выделений
-        SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
-        const double scale = 2.5;
-        SDL_RenderSetScale(ren, scale, scale);
+        // Отрисовка фигур и выделений
         for (POS_T i = 0; i < 8; ++i)
         {
             for (POS_T j = 0; j < 8; ++j)
             {
-                if (!is_highlighted_[i][j])
-                    continue;
-                SDL_Rect cell{ int(W * (j + 1) / 10 / scale), int(H * (i + 1) / 10 / scale), int(W / 10 / scale),
-                              int(H / 10 / scale) };
-                SDL_RenderDrawRect(ren, &cell);
+                draw_cell_content(i, j);
             }
         }
 
-        // Отрисовка активной клетки
-        if (active_x != -1)
-        {
-            SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
-            SDL_Rect active_cell{ int(W * (active_y + 1) / 10 / scale), int(H * (active_x + 1) / 10 / scale),
-                                 int(W / 10 / scale), int(H / 10 / scale) };
-            SDL_RenderDrawRect(ren, &active_cell);
-        }
-        SDL_RenderSetScale(ren, 1, 1);
-
         // Отрисовка кнопок управления
         SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, back, NULL, &rect_left);
+        textures.draw(ren, Sprite::BACK, &rect_left);
         SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, replay, NULL, &replay_rect);
+        textures.draw(ren, Sprite::REPLAY, &replay_rect);
 
         // Отрисовка результата игры
         if (game_results != -1)
         {
-            string result_path = draw_path;
+            Sprite result = Sprite::DRAW;
             if (game_results == 1)
-                result_path = white_path;
+                result = Sprite::WHITE_WINS;
             else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result = Sprite::BLACK_WINS;
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
+            textures.draw(ren, result, &res_rect);
         }
+    }
 
-        SDL_RenderPresent(ren);
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+    // Метод для перерисовки одной клетки: фон доски под ней, фигура и рамки
+    void draw_cell(const POS_T i, const POS_T j)
+    {
+        SDL_Rect cell = cell_rect(i, j);
+        SDL_RenderSetClipRect(ren, &cell);
+        textures.draw(ren, Sprite::BOARD, NULL);
+        draw_cell_content(i, j);
+        SDL_RenderSetClipRect(ren, NULL);
+    }
+
+    // Метод для отрисовки фигуры и рамок выделения клетки поверх фона
+    void draw_cell_content(const POS_T i, const POS_T j)
+    {
+        if (mtx[i][j])
+        {
+            int wpos = W * (j + 1) / 10 + W / 120;
+            int hpos = H * (i + 1) / 10 + H / 120;
+            SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
+
+            Sprite piece = Sprite::BLACK_QUEEN;
+            if (mtx[i][j] == 1)
+                piece = Sprite::WHITE_PIECE;
+            else if (mtx[i][j] == 2)
+                piece = Sprite::BLACK_PIECE;
+            else if (mtx[i][j] == 3)
+                piece = Sprite::WHITE_QUEEN;
+
+            textures.draw(ren, piece, &rect);
+        }
+
+        // Выделение - зеленая рамка, активная клетка - красная
+        if (is_highlighted_[i][j])
+        {
+            SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
+            draw_frame(cell_rect(i, j));
+        }
+        if (active_x == i && active_y == j)
+        {
+            SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
+            draw_frame(cell_rect(i, j));
+        }
+    }
+
+    // Метод для отрисовки рамки по краю прямоугольника текущим цветом
+    void draw_frame(const SDL_Rect& rect)
+    {
+        const SDL_Rect sides[4] = { { rect.x, rect.y, rect.w, FRAME_WIDTH },
+                                    { rect.x, rect.y + rect.h - FRAME_WIDTH, rect.w, FRAME_WIDTH },
+                                    { rect.x, rect.y, FRAME_WIDTH, rect.h },
+                                    { rect.x + rect.w - FRAME_WIDTH, rect.y, FRAME_WIDTH, rect.h } };
+        for (const auto& side : sides)
+            SDL_RenderFillRect(ren, &side);
     }
 
     // Метод для записи ошибок в лог
@@ -371,34 +523,24 @@ private:
 public:
     int W = 0;  // Ширина окна
     int H = 0;  // Высота окна
-    vector<vector<vector<POS_T>>> history_mtx;  // История состояний доски
 
 private:
     SDL_Window* win = nullptr;  // Указатель на окно SDL
     SDL_Renderer* ren = nullptr;  // Указатель на рендерер SDL
-    SDL_Texture* board = nullptr;  // Текстура доски
-    SDL_Texture* w_piece = nullptr;  // Текстура белой фигуры
-    SDL_Texture* b_piece = nullptr;  // Текстура черной фигуры
-    SDL_Texture* w_queen = nullptr;  // Текстура белой дамки
-    SDL_Texture* b_queen = nullptr;  // Текстура черной дамки
-    SDL_Texture* back = nullptr;  // Текстура кнопки "Назад"
-    SDL_Texture* replay = nullptr;  // Текстура кнопки "Перезапуск"
+    TextureCache textures;  // Все текстуры игры, загруженные при запуске
+    SDL_Texture* canvas = nullptr;  // Буфер кадра: нарисованная доска между кадрами (nullptr - рисовать целиком)
     const string textures_path = project_path + "Textures/";  // Путь к текстурам
-    const string board_path = textures_path + "board.png";  // Путь к текстуре доски
-    const string piece_white_path = textures_path + "white_piece.png";  // Путь к текстуре белой фигуры
-    const string piece_black_path = textures_path + "black_piece.png";  // Путь к текстуре черной фигуры
-    const string queen_white_path = textures_path + "white_queen.png";  // Путь к текстуре белой дамки
-    const string queen_black_path = textures_path + "black_queen.png";  // Путь к текстуре черной дамки
-    const string back_path = textures_path + "back.png";  // Путь к текстуре кнопки "Назад"
-    const string replay_path = textures_path + "replay.png";  // Путь к текстуре кнопки "Перезапуск"
-    const string draw_path = textures_path + "draw.png";  // Путь к текстуре ничьей
-    const string white_path = textures_path + "white_win.png";  // Путь к текстуре победы белых
-    const string black_path = textures_path + "black_win.png";  // Путь к текстуре победы черных
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));  // Матрица доски
     vector<vector<int>> is_highlighted_ = vector<vector<int>>(8, vector<int>(8, 0));  // Матрица выделений
     POS_T active_x = -1;  // Координата X активной клетки
     POS_T active_y = -1;  // Координата Y активной клетки
+    vector<vector<int>> dirty = vector<vector<int>>(8, vector<int>(8, 0));  // Клетки, изменившиеся с прошлого кадра
+    bool has_dirty = false;  // Есть ли изменившиеся клетки
+    bool full_redraw = true;  // Нужно ли перерисовать доску целиком
+    static const int FRAME_WIDTH = 3;  // Толщина рамки выделения в пикселях
     int game_results = -1;  // Результат игры (-1: игра продолжается, 0: ничья, 1: победа белых, 2: победа черных)
-    vector<int> history_beat_series;  // История серий битья
+    vector<history_step> history;  // Журнал ходов по шагам
+    uint64_t hash = 0;  // Хэш Зобриста текущей доски (без очереди хода)
+    PositionHistory positions;  // Позиции перед каждым ходом (с учетом очереди хода)
 };
 
@@ -1,25 +1,30 @@
 #pragma once
 #include <fstream>
+#include <string>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
+using std::string;
 
 #include "../Models/Project_path.h"
 
 class Config
 {
 public:
-    Config()
+    // По умолчанию читается settings.json программы, но можно передать путь к другому файлу
+    // (например, чтобы сравнить в матче две конфигурации бота)
+    Config(const string& path = project_path + "settings.json") : path(path)
     {
         reload();
     }
 
-    // Функция reload() перезагружает конфигурационный файл settings.json
+    // Функция reload() перезагружает конфигурационный файл
     // Она открывает файл настроек и парсит его содержимое в объект JSON config
+    // Комментарии // в файле допускаются
     // Используется для обновления настроек без перезапуска программы
     void reload()
     {
-        std::ifstream fin(project_path + "settings.json");
-        fin >> config;
+        std::ifstream fin(path);
+        config = json::parse(fin, nullptr, true, true);
         fin.close();
     }
 
@@ -32,6 +37,26 @@ public:
         return config[setting_dir][setting_name];
     }
 
+    // Тот же доступ, но для настроек, которых может не быть в старых файлах settings.json:
+    // если раздела или настройки нет, возвращается default_value (значение из settings.json по умолчанию)
+    template <class T>
+    T operator()(const string& setting_dir, const string& setting_name, const T& default_value) const
+    {
+        const auto dir = config.find(setting_dir);
+        if (dir == config.end() || !dir->is_object())
+            return default_value;
+        return dir->value(setting_name, default_value);
+    }
+
+    // Функция set() подменяет значение настройки только в памяти, не изменяя файл
+    // Используется инструментами, которым нужны фиксированные настройки бота (например, бенчмарк)
+    // Значение действует до следующего вызова reload()
+    void set(const string& setting_dir, const string& setting_name, const json& value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
 private:
+    string path;
     json config;
 };
@@ -1,16 +1,16 @@
 #pragma once
 #include <chrono>
-#include <thread>
 #include "../Models/Project_path.h"
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
 #include "Logic.h"
+#include "SearchJob.h"
 
 class Game
 {
 public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Height")), hand(&board), logic(&board, &config)
+    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Height")), hand(&board), logic(&config)
     {
         std::ofstream fout(project_path + "log.txt", std::ios_base::trunc);
         fout.close();
@@ -26,7 +26,7 @@ public:
         //    .      .
         if (is_replay)
         {
-            logic = Logic(&board, &config);
+            logic = Logic(&config);
             config.reload();
             board.redraw();
         }
@@ -39,7 +39,9 @@ public:
 
         int turn_num = -1;  //  ,   -1   .
         bool is_quit = false;  //   .
+        bool is_draw = false;  //          .
         const int Max_turns = config("Game", "MaxNumTurns");  //     .
+        const DrawRules draw_rules(config);  //          .
 
         //   .         .
         while (++turn_num < Max_turns)
@@ -47,21 +49,41 @@ public:
             beat_series = 0;  //      .
 
             //       ( ).
-            logic.find_turns(turn_num % 2);
+            logic.find_turns(turn_num % 2, board.get_board());
 
             //       ,  .
             if (logic.turns.empty())
                 break;
 
+            // ,           .
+            if (draw_rules.is_draw(board.position_history(), board.position_key()))
+            {
+                is_draw = true;
+                break;
+            }
+
+            //        .
+            logic.set_position_history(board.position_history().reversible_keys());
+
             //          .
             logic.Max_depth = config("Bot", std::string((turn_num % 2) ? "Black" : "White") + std::string("BotLevel"));
 
             // ,     .
             if (!config("Bot", std::string("Is") + std::string((turn_num % 2) ? "Black" : "White") + std::string("Bot")))
             {
+                //   , -        .
+                const bool bot_color = !(turn_num % 2);
+                if (config("Bot", std::string("Is") + std::string(bot_color ? "Black" : "White") + std::string("Bot")))
+                    logic.start_pondering(bot_color, bit_position::from_mtx(board.get_board()),
+                                          config("Bot", std::string(bot_color ? "Black" : "White") + std::string("BotLevel")));
+
                 //   -.
                 auto resp = player_turn(turn_num % 2);
 
+                //   ,       .
+                if (resp != Response::OK)
+                    logic.stop_pondering();
+
                 //   :   ,       .
                 if (resp == Response::QUIT)
                 {
@@ -77,7 +99,7 @@ public:
                 {
                     //    ,   .
                     if (config("Bot", std::string("Is") + std::string((1 - turn_num % 2) ? "Black" : "White") + std::string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2)
+                        !beat_series && board.history_size() > 1)
                     {
                         board.rollback();
                         --turn_num;
@@ -92,11 +114,24 @@ public:
             }
             else
             {
-                //   .
-                bot_turn(turn_num % 2);
+                //   .   ,       .
+                auto resp = bot_turn(turn_num % 2);
+                if (resp == Response::QUIT)
+                {
+                    is_quit = true;
+                    break;
+                }
+                else if (resp == Response::REPLAY)
+                {
+                    is_replay = true;
+                    break;
+                }
             }
         }
 
+        //     ,      .
+        logic.stop_pondering();
+
         //           .
         auto end = std::chrono::steady_clock::now();
         std::ofstream fout(project_path + "log.txt", std::ios_base::app);
@@ -113,7 +148,7 @@ public:
 
         //   : ,    .
         int res = 2;
-        if (turn_num == Max_turns)
+        if (turn_num == Max_turns || is_draw)
         {
             res = 0;  // .
         }
@@ -137,32 +172,45 @@ public:
     }
 
 private:
-    void bot_turn(const bool color)
+    Response bot_turn(const bool color)
     {
         //          .
         auto start = std::chrono::steady_clock::now();
 
         //       .
-        auto delay_ms = config("Bot", "BotDelayMS");
-
-        //      ,      .
-        std::thread th(SDL_Delay, delay_ms);
+        int delay_ms = config("Bot", "BotDelayMS");
 
-        //          .
-        auto turns = logic.find_best_turns(color);
+        //         ,      .
+        // ,   ,      ,    .
+        SearchJob job(logic, color, bit_position::from_mtx(board.get_board()), nullptr, &Hand::wake);
 
-        //    ,    .
-        th.join();
+        //    ,    ,      .
+        while (!job.ready())
+        {
+            auto resp = hand.poll(-1);
+            if (resp != Response::OK)
+            {
+                //       ,    .
+                job.cancel();
+                return resp;
+            }
+        }
+        auto turns = job.get();
+        auto resp = pause(delay_ms - (int)std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (resp != Response::OK)
+            return resp;
 
         bool is_first = true;  //       .
 
         //       .
-        for (auto turn :; turns);
+        for (auto turn : turns)
         {
-            //       ,    .
+            //       ,        .
             if (!is_first)
             {
-                SDL_Delay(delay_ms);
+                resp = pause(delay_ms);
+                if (resp != Response::OK)
+                    return resp;
             }
             is_first = false;
 
@@ -177,7 +225,27 @@ private:
         auto end = std::chrono::steady_clock::now();
         std::ofstream fout(project_path + "log.txt", std::ios_base::app);
         fout << "Bot turn time: " << (int)std::chrono::duration<double, std::milli>(end - start).count() << " millisec\n";
+        //      JSON,     
+        if (config("Bot", "BotStatsLog", false))
+            fout << "Bot search stats: " << logic.last_stats().log_line() << "\n";
         fout.close();
+        return Response::OK;
+    }
+
+    //     (      ),      .
+    //  QUIT  REPLAY,        .
+    Response pause(const int ms)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (true)
+        {
+            int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()).count();
+            if (left <= 0)
+                return Response::OK;
+            auto resp = hand.poll(left);
+            if (resp != Response::OK)
+                return resp;
+        }
     }
 
     Response player_turn(const bool color)
@@ -274,7 +342,7 @@ private:
         while (true)
         {
             //     
-            logic.find_turns(pos.x2, pos.y2);
+            logic.find_turns(pos.x2, pos.y2, board.get_board());
             if (!logic.have_beats)
                 break;
 
@@ -24,7 +24,7 @@ public:
         // Основной цикл обработки событий
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            if (wait_event(windowEvent, -1))
             {
                 switch (windowEvent.type)
                 {
@@ -41,7 +41,7 @@ public:
                     yc = int(x / (board->W / 10) - 1);
 
                     // Проверяем специальные зоны интерфейса
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
+                    if (xc == -1 && yc == -1 && board->history_size() > 0)
                     {
                         resp = Response::BACK;  // Кнопка "Назад"
                     }
@@ -84,7 +84,7 @@ public:
 
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            if (wait_event(windowEvent, -1))
             {
                 switch (windowEvent.type)
                 {
@@ -92,8 +92,9 @@ public:
                     resp = Response::QUIT;
                     break;
 
-                case SDL_WINDOWEVENT_SIZE_CHANGED:  // Изменение размера окна
-                    board->reset_window_size();
+                case SDL_WINDOWEVENT:  // Изменение размера окна
+                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                        board->reset_window_size();
                     break;
 
                 case SDL_MOUSEBUTTONDOWN:  // Нажатие мыши
@@ -120,7 +121,76 @@ public:
         return resp;
     }
 
+    // Метод обработки событий окна, пока ходит бот: ждет события не дольше timeout_ms
+    // (0 - не ждать, -1 - ждать до события или wake) и обрабатывает все накопившиеся события.
+    // Возвращает QUIT или REPLAY, если игрок закрыл окно или нажал "Переиграть", иначе OK.
+    Response poll(const int timeout_ms = 0) const
+    {
+        SDL_Event windowEvent;
+        Response resp = Response::OK;
+
+        bool has_event = wait_event(windowEvent, timeout_ms);
+        while (has_event)
+        {
+            switch (windowEvent.type)
+            {
+            case SDL_QUIT:  // Закрытие окна
+                resp = Response::QUIT;
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:  // Нажатие мыши: во время хода бота доступна только кнопка "Переиграть"
+            {
+                int xc = int(windowEvent.motion.y / (board->H / 10) - 1);
+                int yc = int(windowEvent.motion.x / (board->W / 10) - 1);
+                if (xc == -1 && yc == 8)
+                    resp = Response::REPLAY;
+            }
+            break;
+
+            case SDL_WINDOWEVENT:  // Изменение размера окна
+                if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                    board->reset_window_size();
+                break;
+            }
+            if (resp != Response::OK)
+                break;
+            has_event = SDL_PollEvent(&windowEvent);
+        }
+        return resp;
+    }
+
+    // Метод, который будит поток, ждущий событий в get_cell, wait или poll.
+    // Можно вызывать из любого потока (например, когда фоновый поиск бота закончен).
+    static void wake()
+    {
+        SDL_Event event{};
+        event.type = wake_event_type();
+        SDL_PushEvent(&event);
+    }
+
 private:
+    // Метод ожидания следующего события: поток спит, пока нет событий, вместо постоянного опроса.
+    // Перед ожиданием на экран выводятся изменения доски, накопившиеся с прошлого кадра.
+    // Потерю буфера кадра рендерером (Direct3D при alt-tab, смене режима экрана, блокировке)
+    // обрабатывает сама доска, вызывающим такие события не нужны.
+    bool wait_event(SDL_Event& windowEvent, const int timeout_ms) const
+    {
+        board->present();
+        const bool got = timeout_ms == 0 ? SDL_PollEvent(&windowEvent) : SDL_WaitEventTimeout(&windowEvent, timeout_ms);
+        if (got && windowEvent.type == SDL_RENDER_TARGETS_RESET)
+            board->render_targets_reset();
+        else if (got && windowEvent.type == SDL_RENDER_DEVICE_RESET)
+            board->render_device_reset();
+        return got;
+    }
+
+    // Тип пользовательского события для wake, регистрируется в SDL один раз
+    static Uint32 wake_event_type()
+    {
+        static const Uint32 type = SDL_RegisterEvents(1);
+        return type;
+    }
+
     Board* board;  // Указатель на объект игрового поля
 };
 
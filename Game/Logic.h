@@ -3,153 +3,500 @@
 #include <vector>
 #include <algorithm>
 #include <random>
-#include <ctime>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <future>
+#include <functional>
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/Position.h"
 #include "Config.h"
+#include "TransTable.h"
+#include "SearchStats.h"
+#include "Tablebase.h"
+#include "OpeningBook.h"
 
 const int INF = 1e9;
+const int MAX_PLY = 128; // Максимальная глубина, для которой хранятся ходы-убийцы
+
+// Профили поиска из настройки Optimization
+enum class Optimization {
+    O0, // Полный минимакс без отсечений
+    O1, // Альфа-бета отсечение с таблицей транспозиций
+    O2  // O1 и выборочный поиск: нулевое окно (PVS), сокращение поздних ходов (LMR), futility pruning
+};
+
+// Оценочная функция из настройки BotScoringType
+enum class Scoring {
+    NumberOnly,        // Только количество фигур
+    NumberAndPotential // Количество фигур и продвижение пешек
+};
+
+// Политики оценки для каждого Scoring: материал одного цвета (индекс 0 - белые, 1 - черные).
+// Перебор инстанцируется под каждую политику, поэтому выбор оценки не стоит ничего в узлах поиска.
+// Новая оценка - еще одна такая структура, значение Scoring и строка в конструкторе Logic.
+struct NumberOnlyEval {
+    static double material(const eval_terms& e, const int color) {
+        return e.pawns[color] + 4.0 * e.queens[color];
+    }
+};
+
+struct NumberAndPotentialEval {
+    static double material(const eval_terms& e, const int color) {
+        return e.pawns[color] + 0.05 * e.advance[color] + 5.0 * e.queens[color];
+    }
+};
 
 class Logic {
+    friend class SearchJob;
+
 public:
     /**
-     * Конструктор класса Logic.
-     * @param board Указатель на объект доски.
+     * Конструктор класса Logic. Логика не зависит от Board и SDL:
+     * позиция передается в каждый вызов, поэтому движок можно использовать без окна.
      * @param config Указатель на объект конфигурации.
      */
-    Logic(Board* board, Config* config) : board(board), config(config) {
-        rand_eng = std::default_random_engine(
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
-        scoring_mode = (*config)("Bot", "BotScoringType");
-        optimization = (*config)("Bot", "Optimization");
+    Logic(Config* config) : config(config) {
+        no_random = (*config)("Bot", "NoRandom");
+        rand_eng = std::default_random_engine(!no_random ? std::random_device{}() : 0);
+        const std::string scoring = (*config)("Bot", "BotScoringType");
+        scoring_mode = scoring == "NumberAndPotential" ? Scoring::NumberAndPotential : Scoring::NumberOnly;
+        iterate_fn = scoring_mode == Scoring::NumberAndPotential ? &Logic::iterate<NumberAndPotentialEval>
+                                                                 : &Logic::iterate<NumberOnlyEval>;
+        const std::string opt = (*config)("Bot", "Optimization");
+        optimization = opt == "O0" ? Optimization::O0 : (opt == "O2" ? Optimization::O2 : Optimization::O1);
+        tt = std::make_shared<TransTable>((*config)("Bot", "HashSizeMB", 64));
+        stop_flag = std::make_shared<std::atomic<bool>>(false);
+        threads_count = (*config)("Bot", "BotThreads", 0);
+        if (threads_count == 0)
+            threads_count = std::max(1u, std::thread::hardware_concurrency());
+        time_limit_ms = (*config)("Bot", "BotTimeMS", 2000);
+        quiescence_limit = (*config)("Bot", "QuiescenceNodes", 1000);
+        pondering = (*config)("Bot", "Pondering", false);
+        const std::string tb_path = (*config)("Bot", "TablebasePath", std::string());
+        if (!tb_path.empty()) {
+            auto base = std::make_shared<Tablebase>();
+            if (base->load(project_path + tb_path))
+                tablebase = base;
+        }
+        const std::string book_path = (*config)("Bot", "OpeningBookPath", std::string());
+        if (!book_path.empty()) {
+            auto opening_book = std::make_shared<OpeningBook>();
+            if (opening_book->load(project_path + book_path))
+                book = opening_book;
+        }
     }
 
     /**
      * Выполняет ход на доске.
-     * @param mtx Текущее состояние доски.
+     * @param pos Текущая позиция.
      * @param turn Ход, который нужно выполнить.
-     * @return Новое состояние доски после выполнения хода.
+     * @return Новая позиция после выполнения хода.
      */
-    std::vector<std::vector<POS_T>> make_turn(std::vector<std::vector<POS_T>> mtx, move_pos turn) const {
-        if (turn.xb != -1)
-            mtx[turn.xb][turn.yb] = 0; // Удаляем побитую фигуру
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
-            mtx[turn.x][turn.y] += 2; // Превращаем пешку в дамку
-        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y]; // Перемещаем фигуру
-        mtx[turn.x][turn.y] = 0; // Очищаем исходную позицию
-        return mtx;
+    bit_position make_turn(bit_position pos, const bit_move& turn) const {
+        pos.do_move(turn);
+        return pos;
     }
 
     /**
      * Рассчитывает оценку текущего состояния доски.
-     * @param mtx Текущее состояние доски.
-     * @param first_bot_color Цвет бота (true - белые, false - черные).
-     * @return Оценка состояния доски (чем меньше значение, тем лучше для бота).
-     */
-    double calc_score(const std::vector<std::vector<POS_T>>& mtx, const bool first_bot_color) const {
-        double w = 0, wq = 0, b = 0, bq = 0;
-        for (POS_T i = 0; i < 8; ++i) {
-            for (POS_T j = 0; j < 8; ++j) {
-                w += (mtx[i][j] == 1); // Считаем белые пешки
-                wq += (mtx[i][j] == 3); // Считаем белые дамки
-                b += (mtx[i][j] == 2); // Считаем черные пешки
-                bq += (mtx[i][j] == 4); // Считаем черные дамки
-                if (scoring_mode == "NumberAndPotential") {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i); // Потенциал белых пешек
-                    b += 0.05 * (mtx[i][j] == 2) * (i); // Потенциал черных пешек
-                }
-            }
-        }
-        if (!first_bot_color) {
-            std::swap(b, w);
-            std::swap(bq, wq);
-        }
-        if (w + wq == 0)
-            return INF;
-        if (b + bq == 0)
-            return 0;
-        int q_coef = 4;
-        if (scoring_mode == "NumberAndPotential") {
-            q_coef = 5;
-        }
-        return (b + bq * q_coef) / (w + wq * q_coef);
+     * @param pos Текущая позиция.
+     * @param first_bot_color Цвет, для которого считается оценка (true - черные, false - белые).
+     * @return Отношение материала цвета first_bot_color к материалу соперника (чем больше, тем лучше).
+     */
+    double calc_score(const bit_position& pos, const bool first_bot_color) const {
+        // Материал и продвижение пешек поддерживаются в позиции при каждом ходе, поэтому оценка - O(1)
+        if (scoring_mode == Scoring::NumberAndPotential)
+            return score_ratio<NumberAndPotentialEval>(pos, first_bot_color);
+        return score_ratio<NumberOnlyEval>(pos, first_bot_color);
     }
 
     /**
-     * Находит все возможные ходы для заданного цвета.
+     * Находит все возможные ходы для заданного цвета по одному шагу, как их делает игрок.
      * @param color Цвет игрока.
+     * @param mtx Текущее состояние доски.
      */
-    void find_turns(const bool color) {
-        find_turns(color, board->get_board());
+    void find_turns(const bool color, const std::vector<std::vector<POS_T>>& mtx) {
+        find_turns(color, bit_position::from_mtx(mtx));
     }
 
     /**
      * Находит все возможные ходы для фигуры на позиции (x, y).
      * @param x Координата x фигуры.
      * @param y Координата y фигуры.
+     * @param mtx Текущее состояние доски.
+     */
+    void find_turns(const POS_T x, const POS_T y, const std::vector<std::vector<POS_T>>& mtx) {
+        find_turns(x, y, bit_position::from_mtx(mtx));
+    }
+
+    /**
+     * Находит все возможные ходы для заданного цвета в заданной позиции.
+     * @param color Цвет игрока.
+     * @param pos Текущая позиция.
+     */
+    void find_turns(const bool color, const bit_position& pos) {
+        move_list list;
+        have_beats = pos.gen_steps(color, list);
+        set_turns(list);
+        std::shuffle(turns.begin(), turns.end(), rand_eng);
+    }
+
+    /**
+     * Находит все возможные ходы для фигуры на позиции (x, y) в заданной позиции.
+     * @param x Координата x фигуры.
+     * @param y Координата y фигуры.
+     * @param pos Текущая позиция.
      */
-    void find_turns(const POS_T x, const POS_T y) {
-        find_turns(x, y, board->get_board());
+    void find_turns(const POS_T x, const POS_T y, const bit_position& pos) {
+        move_list list;
+        const int sq = sq_index(x, y);
+        have_beats = sq != -1 && pos.at(sq) && pos.gen_steps_from(sq, list);
+        set_turns(list);
     }
 
     /**
-     * Находит лучший ход для бота, используя рекурсивный поиск.
+     * Находит лучший ход для бота на доске mtx.
      * @param color Цвет бота.
-     * @param depth Глубина поиска.
-     * @return Лучший ход.
+     * @param mtx Текущее состояние доски.
+     * @return Лучший ход по шагам (см. перегрузку для bit_position).
+     */
+    std::vector<move_pos> find_best_turns(const bool color, const std::vector<std::vector<POS_T>>& mtx) {
+        return find_best_turns(color, bit_position::from_mtx(mtx));
+    }
+
+    /**
+     * Находит лучший ход для бота итеративным углублением: глубина 1, 2, ..., Max_depth + 1.
+     * Если позиция есть в дебютной книге, ход берется из неё без перебора.
+     * Если соперник сделал предсказанный ход, используется поиск, который шел во время его хода (start_pondering).
+     * Если задан BotTimeMS, поиск останавливается по истечении времени
+     * и возвращается лучший ход последней завершенной глубины.
+     * При BotThreads > 1 вместе с основным поиском работают помощники (Lazy SMP):
+     * копии Logic с общей таблицей транспозиций, которые заполняют её из своих потоков.
+     * @param color Цвет бота.
+     * @param pos Текущая позиция.
+     * @return Лучший ход по шагам: серия взятий целиком (пустой список, если ходов нет).
      */
-    move_pos find_best_turns(const bool color, int depth) {
-        Max_depth = depth;
+    std::vector<move_pos> find_best_turns(const bool color, const bit_position& pos) {
+        start_time = std::chrono::steady_clock::now();
+        if (take_ponder_result(color, pos))
+            return search_pos.expand(next_move.front());
         next_move.clear();
-        next_best_state.clear();
 
         // Инициализация поиска
-        find_first_best_turn(color, board->get_board(), depth);
+        search_pos = pos;
+        undo_stack.clear();
+        tt->new_search();
+        for (auto& k : killers)
+            k[0] = k[1] = bit_move();
+        age_history();
+        stopped = false;
+        nodes = 0;
+        stats = search_stats();
+
+        bit_move book_turn;
+        if (probe_book(color, book_turn)) {
+            next_move = { book_turn };
+            next_best_state = make_turn(search_pos, book_turn);
+            stats.book_move = true;
+            stats.pv = next_move;
+            stats.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            return search_pos.expand(book_turn);
+        }
+
+        // Помощники начинают с разной глубины, чтобы не повторять один и тот же перебор
+        std::vector<Logic> helpers(threads_count - 1, *this);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < helpers.size(); ++i) {
+            helpers[i].rand_eng.seed(unsigned(rand_eng()) + unsigned(i));
+            helpers[i].on_progress = nullptr;
+            workers.emplace_back(iterate_fn, &helpers[i], color, int(2 + i % 2));
+        }
+
+        (this->*iterate_fn)(color, 1);
 
-        // Возвращаем найденный лучший ход
-        return next_move.empty() ? move_pos{ -1, -1, -1, -1, -1, -1 } : next_move.front();
+        stop_flag->store(true);
+        for (auto& worker : workers)
+            worker.join();
+        // Флаг сбрасывается после поиска, а не перед ним, чтобы остановка, запрошенная до начала поиска, не терялась
+        stop_flag->store(false);
+
+        // Если помощник успел досчитать большую глубину, берем его ход
+        for (const auto& helper : helpers) {
+            nodes += helper.nodes;
+            stats.leaf_evals += helper.stats.leaf_evals;
+            stats.beta_cutoffs += helper.stats.beta_cutoffs;
+            stats.first_move_cutoffs += helper.stats.first_move_cutoffs;
+            stats.tt_probes += helper.stats.tt_probes;
+            stats.tt_hits += helper.stats.tt_hits;
+            stats.tb_hits += helper.stats.tb_hits;
+            if (helper.completed_depth > completed_depth && !helper.next_move.empty()) {
+                completed_depth = helper.completed_depth;
+                next_move = helper.next_move;
+                next_best_state = helper.next_best_state;
+                stats.score = helper.stats.score;
+            }
+        }
+        stats.nodes = nodes;
+        stats.depth = completed_depth;
+        stats.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        if (!next_move.empty())
+            stats.pv = principal_variation(color, next_move.front());
+
+        // Возвращаем найденный лучший ход, серию взятий - по шагам
+        if (next_move.empty())
+            return {};
+        return search_pos.expand(next_move.front());
+    }
+
+    /**
+     * Запускает фоновый поиск на время хода соперника (если включен Pondering).
+     * Ищется ответ на ход соперника, предсказанный главным вариантом прошлого поиска;
+     * если предсказания нет, перебирается сама позиция соперника, чтобы заполнить таблицу транспозиций.
+     * Фоновый поиск - копия Logic с общей таблицей транспозиций и своим флагом остановки.
+     * Он всегда однопоточный, независимо от BotThreads, чтобы пока думает человек, бот занимал одно ядро, а не все.
+     * @param color Цвет бота.
+     * @param pos Позиция, в которой ходит соперник.
+     * @param depth Уровень бота (Max_depth для его следующего хода).
+     */
+    void start_pondering(const bool color, const bit_position& pos, const int depth) {
+        stop_pondering();
+        if (!pondering)
+            return;
+        auto job = std::make_shared<ponder_job>();
+        job->color = color;
+        job->pos = pos;
+        bool predicted = false;
+        if (stats.pv.size() >= 2 && next_best_state == pos) {
+            move_list list;
+            pos.gen_turns(!color, list);
+            for (const auto& turn : list)
+                predicted = predicted || turn == stats.pv[1];
+        }
+        if (predicted)
+            job->pos.do_move(stats.pv[1]);
+        else
+            job->color = !color;
+        job->engine = std::make_unique<Logic>(*this);
+        // Позиция соперника тоже становится частью истории партии
+        job->engine->game_keys.push_back(OpeningBook::position_key(pos, !color));
+        std::sort(job->engine->game_keys.begin(), job->engine->game_keys.end());
+        job->engine->ponder.reset();
+        job->engine->on_progress = nullptr;
+        job->engine->stop_flag = std::make_shared<std::atomic<bool>>(false);
+        job->engine->time_limit_ms = 0;
+        job->engine->threads_count = 1;
+        job->engine->Max_depth = depth;
+        Logic* engine = job->engine.get();
+        const bool search_color = job->color;
+        const bit_position ponder_pos = job->pos;
+        job->result = std::async(std::launch::async, [engine, search_color, ponder_pos]() {
+            engine->find_best_turns(search_color, ponder_pos);
+        });
+        ponder = job;
+    }
+
+    /**
+     * Останавливает фоновый поиск и ждет завершения его потоков. Результат отбрасывается,
+     * но всё, что поиск успел записать в таблицу транспозиций, остается.
+     */
+    void stop_pondering() {
+        ponder.reset();
+    }
+
+    /**
+     * Задает позиции партии, которые были до текущей: поиск оценивает их повторение как ничью.
+     * Достаточно позиций после последнего взятия или хода простой (PositionHistory::reversible_keys),
+     * более ранние повториться уже не могут.
+     * @param keys Ключи позиций перед ходами в формате position_key (с учетом очереди хода).
+     */
+    void set_position_history(std::vector<uint64_t> keys) {
+        std::sort(keys.begin(), keys.end());
+        game_keys = std::move(keys);
+    }
+
+    /**
+     * Просит идущий поиск остановиться: find_best_turns вернет лучший ход последней завершенной глубины.
+     * Можно вызывать из другого потока. Запрос, сделанный до начала поиска, остановит следующий поиск.
+     */
+    void stop_search() {
+        stop_flag->store(true);
+    }
+
+    /**
+     * Число узлов, просмотренных последним поиском (всеми потоками).
+     * @return Количество узлов.
+     */
+    uint64_t searched_nodes() const {
+        return nodes;
+    }
+
+    /**
+     * Статистика последнего поиска: узлы, отсечения, попадания в таблицу транспозиций,
+     * время по глубинам и главный вариант. Время и узлы по глубинам - только основного потока.
+     * @return Статистика последнего вызова find_best_turns.
+     */
+    const search_stats& last_stats() const {
+        return stats;
     }
 
 private:
+    /**
+     * Отношение материала цвета color к материалу соперника по политике оценки Eval.
+     * @param pos Позиция.
+     * @param color Цвет, для которого считается оценка.
+     * @return INF, если у соперника нет фигур, 0 - если их нет у color.
+     */
+    template <class Eval>
+    static double score_ratio(const bit_position& pos, const bool color) {
+        const double own = Eval::material(pos.eval, color), opp = Eval::material(pos.eval, !color);
+        if (opp == 0)
+            return INF;
+        if (own == 0)
+            return 0;
+        return own / opp;
+    }
+
+    /**
+     * Итеративное углубление от глубины first_depth до Max_depth + 1.
+     * Выбирается в конструкторе по BotScoringType, дальше перебор специализирован по оценке и цвету.
+     * @tparam Eval Политика оценки.
+     * @param color Цвет бота.
+     * @param first_depth Начальная глубина.
+     */
+    template <class Eval>
+    void iterate(const bool color, const int first_depth) {
+        completed_depth = 0;
+        for (int depth = first_depth; depth <= Max_depth + 1; ++depth) {
+            iter_depth = depth;
+            const auto iter_start = std::chrono::steady_clock::now();
+            const uint64_t iter_nodes = nodes;
+            if (!(color ? find_first_best_turn<true, Eval>(depth) : find_first_best_turn<false, Eval>(depth)))
+                break;
+            completed_depth = depth;
+            stats.depth_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - iter_start).count());
+            stats.depth_nodes.push_back(nodes - iter_nodes);
+            if (on_progress)
+                on_progress({ depth, stats.score, nodes,
+                              std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count(),
+                              next_move.front() });
+            // Следующая глубина почти наверняка не успеет завершиться
+            if (time_limit_ms && elapsed_ms() * 2 > time_limit_ms)
+                break;
+        }
+    }
+
     /**
      * Рекурсивная функция для поиска лучшего хода.
-     * @param color Цвет текущего игрока.
-     * @param mtx Текущее состояние доски.
+     * Оценка считается с точки зрения черных: черные максимизируют её, белые минимизируют.
+     * Ходы выполняются и отменяются на месте в search_pos.
+     * @tparam color Цвет текущего игрока.
+     * @tparam Eval Политика оценки.
      * @param depth Текущая глубина поиска.
      * @param alpha Значение альфа для альфа-бета отсечения.
      * @param beta Значение бета для альфа-бета отсечения.
      * @return Лучшая оценка для текущего состояния.
      */
-    double find_best_turns_rec(const bool color, std::vector<std::vector<POS_T>> mtx, int depth, double alpha, double beta) {
+    template <bool color, class Eval>
+    double find_best_turns_rec(int depth, double alpha, double beta) {
+        if (check_stop())
+            return 0;
+        // Повторение позиции - ничья: в эндшпиле дамок это отсекает целые циклы перестановок
+        if (!undo_stack.empty() && is_repetition(color))
+            return DRAW_SCORE;
+        double tb_score;
+        if (probe_tablebase(color, tb_score))
+            return tb_score;
         if (depth == 0) {
-            return calc_score(mtx, color);
+            quiescence_left = quiescence_limit;
+            return quiescence<color, Eval>(alpha, beta);
+        }
+
+        // O0 - полный минимакс: окно не сужается и таблица транспозиций не используется
+        const bool pruning = optimization != Optimization::O0;
+        const bool selective = optimization == Optimization::O2;
+
+        // Позиция уже могла встретиться при другом порядке ходов
+        const uint64_t key = position_key(color);
+        tt_data entry;
+        const bool tt_hit = pruning && tt->probe(key, entry);
+        stats.tt_probes += pruning;
+        stats.tt_hits += tt_hit;
+        if (tt_hit && entry.depth >= depth) {
+            if (entry.bound == Bound::EXACT ||
+                (entry.bound == Bound::LOWER && entry.score >= beta) ||
+                (entry.bound == Bound::UPPER && entry.score <= alpha))
+                return entry.score;
         }
 
         // Находим все возможные ходы для текущего игрока
-        find_turns(color, mtx);
-        if (turns.empty()) {
-            return calc_score(mtx, color);
+        move_list list;
+        search_pos.gen_turns<color>(list);
+        if (list.empty()) {
+            return color ? 0 : INF; // Игрок без ходов проигрывает
         }
+        const int ply = std::min(int(undo_stack.size()), MAX_PLY - 1);
+        const bit_move hash_turn(entry.from, entry.to, entry.captured);
+        order_turns(list, color, ply, tt_hit && entry.has_move ? &hash_turn : nullptr);
 
+        const double alpha_orig = alpha, beta_orig = beta;
         double best_score = color ? -INF : INF;
+        const bit_move* best_turn = nullptr;
 
-        for (const auto& turn : turns) {
-            // Создаем новое состояние доски после выполнения хода
-            auto new_mtx = make_turn(mtx, turn);
+        // Futility pruning: на последнем уровне тихий ход почти не меняет оценку,
+        // поэтому если даже с запасом она не достает до окна, такие ходы не проверяем
+        bool futile = false;
+        double futile_score = 0;
+        if (selective && depth == 1) {
+            const double static_score = score_ratio<Eval>(search_pos, true);
+            ++stats.leaf_evals;
+            futile_score = color ? static_score + FUTILITY_MARGIN : static_score - FUTILITY_MARGIN;
+            futile = color ? futile_score <= alpha : futile_score >= beta;
+        }
+
+        for (int i = 0; i < list.size; ++i) {
+            const auto& turn = list[i];
+            const bool quiet = !turn.captured && !is_promotion(turn);
+            if (futile && quiet && i > 0) {
+                if ((color && futile_score > best_score) || (!color && futile_score < best_score))
+                    best_score = futile_score;
+                continue;
+            }
 
             // Рекурсивно вызываем функцию для следующего уровня
-            double score = find_best_turns_rec(!color, new_mtx, depth - 1, alpha, beta);
+            do_move(turn);
+            double score;
+            if (!selective || i == 0) {
+                score = find_best_turns_rec<!color, Eval>(depth - 1, alpha, beta);
+            }
+            else {
+                // Поздние тихие ходы сначала проверяем на меньшей глубине
+                const int reduction = (depth >= 3 && i >= 3 && quiet &&
+                                       turn != killers[ply][0] && turn != killers[ply][1]) ? 1 : 0;
+                // Нулевое окно: проверяем только, улучшает ли ход границу текущего игрока
+                const double lo = color ? alpha : beta - NULL_WINDOW;
+                const double hi = color ? alpha + NULL_WINDOW : beta;
+                score = find_best_turns_rec<!color, Eval>(depth - 1 - reduction, lo, hi);
+                const bool improves = color ? score > alpha : score < beta;
+                if (improves && (reduction || (score > alpha && score < beta)))
+                    score = find_best_turns_rec<!color, Eval>(depth - 1, alpha, beta);
+            }
+            undo_move();
+            if (stopped)
+                return 0; // Результат прерванного поиска не сохраняем
 
-            // Обновляем лучший ход и оценку
+            // Обновляем лучшую оценку
             if ((color && score > best_score) || (!color && score < best_score)) {
                 best_score = score;
-                if (depth == Max_depth) {
-                    next_move = { turn };
-                    next_best_state = new_mtx;
-                }
+                best_turn = &turn;
             }
 
             // Альфа-бета отсечение
+            if (!pruning) {
+                continue;
+            }
             if (color) {
                 alpha = std::max(alpha, score);
             }
@@ -157,143 +504,472 @@ private:
                 beta = std::min(beta, score);
             }
             if (beta <= alpha) {
+                ++stats.beta_cutoffs;
+                stats.first_move_cutoffs += (i == 0);
+                // Тихий ход, вызвавший отсечение, запоминаем для упорядочивания
+                if (!turn.captured) {
+                    if (killers[ply][0] != turn) {
+                        killers[ply][1] = killers[ply][0];
+                        killers[ply][0] = turn;
+                    }
+                    add_history(color, turn, depth);
+                }
                 break;
             }
         }
 
+        Bound bound = Bound::EXACT;
+        if (best_score <= alpha_orig)
+            bound = Bound::UPPER;
+        else if (best_score >= beta_orig)
+            bound = Bound::LOWER;
+        if (pruning)
+            tt->store(key, best_score, depth, bound, best_turn);
         return best_score;
     }
 
     /**
-     * Инициализирует поиск первого лучшего хода.
+     * Поиск спокойной позиции в листьях: пока у игрока есть обязательные взятия,
+     * перебор продолжается только по ним, чтобы не оценивать позицию посреди размена.
+     * Число узлов одного такого поиска ограничено QuiescenceNodes.
+     * @tparam color Цвет текущего игрока.
+     * @tparam Eval Политика оценки.
+     * @param alpha Значение альфа для альфа-бета отсечения.
+     * @param beta Значение бета для альфа-бета отсечения.
+     * @return Оценка позиции с точки зрения черных.
+     */
+    template <bool color, class Eval>
+    double quiescence(double alpha, double beta) {
+        if (check_stop())
+            return 0;
+        double tb_score;
+        if (probe_tablebase(color, tb_score))
+            return tb_score;
+        move_list list;
+        const bool beats = search_pos.gen_turns<color>(list);
+        if (list.empty()) {
+            return color ? 0 : INF; // Игрок без ходов проигрывает
+        }
+        if (!beats || quiescence_left <= 0) {
+            ++stats.leaf_evals;
+            return score_ratio<Eval>(search_pos, true);
+        }
+        --quiescence_left;
+
+        const int ply = std::min(int(undo_stack.size()), MAX_PLY - 1);
+        order_turns(list, color, ply, nullptr);
+        double best_score = color ? -INF : INF;
+        for (const auto& turn : list) {
+            do_move(turn);
+            const double score = quiescence<!color, Eval>(alpha, beta);
+            undo_move();
+            if (stopped)
+                return 0;
+            if ((color && score > best_score) || (!color && score < best_score))
+                best_score = score;
+            if (optimization == Optimization::O0)
+                continue;
+            if (color)
+                alpha = std::max(alpha, score);
+            else
+                beta = std::min(beta, score);
+            if (beta <= alpha)
+                break;
+        }
+        return best_score;
+    }
+
+    /**
+     * Проверяет, превращается ли пешка в дамку этим ходом.
+     * @param turn Ход в позиции поиска.
+     * @return true для хода пешки на последнюю для неё строку.
+     */
+    bool is_promotion(const bit_move& turn) const {
+        const BB_T from = BB_T(1) << turn.from, to = BB_T(1) << turn.to;
+        if (search_pos.kings & from)
+            return false;
+        if (turn.promote)
+            return true;
+        return (search_pos.white & from) ? (to & BB_ROW_0) != 0 : (to & BB_ROW_7) != 0;
+    }
+
+    /**
+     * Ищет позицию поиска в базе эндшпиля, если фигур осталось мало.
+     * Выигрыш черных оценивается выше любого соотношения материала, и чем быстрее, тем лучше;
+     * выигрыш белых - ниже любого соотношения, и чем дальше, тем лучше для черных.
+     * Правило DrawQuietTurns база не учитывает: она хранит число полуходов до конца партии,
+     * а не до ближайшего взятия, поэтому выигрыш длиннее оставшегося запаса тихих ходов
+     * всё равно считается выигрышем, хотя партия может закончиться ничьей раньше.
+     * @param color Цвет, который ходит.
+     * @param score Точная оценка с точки зрения черных.
+     * @return true, если позиция найдена в базе.
+     */
+    bool probe_tablebase(const bool color, double& score) {
+        if (!tablebase || bb_count(search_pos.white | search_pos.black) > tablebase->max_pieces())
+            return false;
+        tb_entry entry;
+        if (!tablebase->probe(search_pos, color, entry))
+            return false;
+        ++stats.tb_hits;
+        if (entry.result == TbResult::DRAW) {
+            score = DRAW_SCORE;
+            return true;
+        }
+        const bool black_wins = (entry.result == TbResult::WIN) == color;
+        score = black_wins ? TB_WIN - entry.distance : TB_LOSS_STEP * entry.distance;
+        return true;
+    }
+
+    /**
+     * Забирает результат фонового поиска, если он шел в позиции pos за цвет color.
+     * Незаконченный поиск продолжается, пока не кончится время хода (или до конца, если BotTimeMS не задан)
+     * или пока этот поиск не остановят снаружи (stop_search).
+     * В остальных случаях фоновый поиск останавливается.
      * @param color Цвет бота.
-     * @param mtx Текущее состояние доски.
-     * @param depth Глубина поиска.
+     * @param pos Текущая позиция.
+     * @return true, если next_move, next_best_state и stats взяты из фонового поиска.
      */
-    void find_first_best_turn(const bool color, const std::vector<std::vector<POS_T>>& mtx, int depth) {
-        find_best_turns_rec(color, mtx, depth, -INF, INF);
+    bool take_ponder_result(const bool color, const bit_position& pos) {
+        const std::shared_ptr<ponder_job> job = std::move(ponder);
+        ponder.reset();
+        if (!job || job->color != color || job->pos != pos)
+            return false;
+        while (job->result.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {
+            if (stop_flag->load() || (time_limit_ms && elapsed_ms() >= time_limit_ms))
+                job->engine->stop_flag->store(true);
+        }
+        stop_flag->store(false);
+        const Logic& engine = *job->engine;
+        if (engine.next_move.empty())
+            return false;
+        search_pos = pos;
+        next_move = engine.next_move;
+        next_best_state = engine.next_best_state;
+        completed_depth = engine.completed_depth;
+        nodes = engine.nodes;
+        stats = engine.stats;
+        stats.ponder_hit = true;
+        stats.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        return true;
     }
 
     /**
-     * Находит все возможные ходы для заданного цвета на заданной доске.
-     * @param color Цвет игрока.
-     * @param mtx Текущее состояние доски.
+     * Выбирает ход из дебютной книги для позиции поиска. С NoRandom берется ход с наибольшим весом,
+     * иначе ход выбирается случайно пропорционально весам.
+     * @param color Цвет бота.
+     * @param turn Выбранный ход.
+     * @return true, если в книге есть допустимый ход для этой позиции.
      */
-    void find_turns(const bool color, const std::vector<std::vector<POS_T>>& mtx) {
-        std::vector<move_pos> res_turns;
-        bool have_beats_before = false;
-        for (POS_T i = 0; i < 8; ++i) {
-            for (POS_T j = 0; j < 8; ++j) {
-                if (mtx[i][j] && mtx[i][j] % 2 != color) {
-                    find_turns(i, j, mtx);
-                    if (have_beats && !have_beats_before) {
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before) {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
+    bool probe_book(const bool color, bit_move& turn) {
+        if (!book)
+            return false;
+        const auto entries = book->probe(OpeningBook::position_key(search_pos, color));
+        if (entries.empty())
+            return false;
+        move_list list;
+        search_pos.gen_turns(color, list);
+        std::vector<bit_move> candidates;
+        std::vector<uint32_t> weights;
+        for (const auto& entry : entries) {
+            for (const auto& legal : list) {
+                // Проверяем ход, чтобы совпадение хэшей двух разных позиций не дало недопустимый ход
+                if (legal.from == entry.turn.from && legal.to == entry.turn.to && legal.captured == entry.turn.captured) {
+                    candidates.push_back(legal);
+                    weights.push_back(std::max<uint32_t>(entry.weight, 1));
+                    break;
                 }
             }
         }
-        turns = res_turns;
-        std::shuffle(turns.begin(), turns.end(), rand_eng);
-        have_beats = have_beats_before;
+        if (candidates.empty())
+            return false;
+        // Записи книги идут по убыванию веса
+        size_t choice = 0;
+        if (!no_random)
+            choice = std::discrete_distribution<size_t>(weights.begin(), weights.end())(rand_eng);
+        turn = candidates[choice];
+        return true;
     }
 
     /**
-     * Находит все возможные ходы для фигуры на позиции (x, y) на заданной доске.
-     * @param x Координата x фигуры.
-     * @param y Координата y фигуры.
-     * @param mtx Текущее состояние доски.
+     * Ключ позиции поиска с учетом того, чей ход.
+     * @param color Цвет игрока, который ходит.
+     * @return Ключ для таблицы транспозиций.
      */
-    void find_turns(const POS_T x, const POS_T y, const std::vector<std::vector<POS_T>>& mtx) {
-        turns.clear();
-        have_beats = false;
-        POS_T type = mtx[x][y];
-
-        // Проверяем возможность взятия
-        switch (type) {
-        case 1:
-        case 2:
-            // Проверяем пешки
-            for (POS_T i = x - 2; i <= x + 2; i += 4) {
-                for (POS_T j = y - 2; j <= y + 2; j += 4) {
-                    if (i < 0 || i > 7 || j < 0 || j > 7)
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2;
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb);
-                }
+    uint64_t position_key(const bool color) const {
+        return search_pos.hash ^ (color ? ZOBRIST.side : 0);
+    }
+
+    /**
+     * Проверяет, встречалась ли позиция поиска раньше с тем же игроком на ходу:
+     * на пути перебора или в партии до начала поиска (set_position_history).
+     * Путь просматривается только до последнего взятия или превращения: позиции до них повториться не могут.
+     * @param color Цвет игрока, который ходит.
+     * @return true, если позиция повторилась.
+     */
+    bool is_repetition(const bool color) const {
+        const int ply = int(undo_stack.size());
+        for (int k = ply - 1; k >= 0; --k) {
+            const undo_info& step = undo_stack[k];
+            if ((ply - k) % 2 == 0 && step.hash == search_pos.hash)
+                return true;
+            if (step.turn.captured || step.promoted)
+                return false;
+        }
+        return std::binary_search(game_keys.begin(), game_keys.end(), position_key(color));
+    }
+
+    /**
+     * Перебор корня на одной глубине итеративного углубления.
+     * Лучший ход предыдущей глубины проверяется первым. Ходы с равной лучшей оценкой
+     * получают точную оценку, и случайность используется только для выбора среди них.
+     * @tparam color Цвет бота.
+     * @tparam Eval Политика оценки.
+     * @param depth Глубина поиска.
+     * @return true, если глубина просчитана полностью и next_move обновлен.
+     */
+    template <bool color, class Eval>
+    bool find_first_best_turn(int depth) {
+        move_list list;
+        search_pos.gen_turns<color>(list);
+        if (list.empty())
+            return false;
+        order_turns(list, color, 0, next_move.empty() ? nullptr : &next_move.front());
+
+        const double eps = 1e-6;
+        double alpha = -INF, beta = INF;
+        double best_score = color ? -INF - 1 : INF + 1;
+        std::vector<bit_move> best_turns;
+        for (const auto& turn : list) {
+            do_move(turn);
+            double score = find_best_turns_rec<!color, Eval>(depth - 1, alpha, beta);
+            undo_move();
+            if (stopped)
+                return false;
+            if ((color && score > best_score + eps) || (!color && score < best_score - eps)) {
+                best_score = score;
+                best_turns = { turn };
             }
-            break;
-        default:
-            // Проверяем дамки
-            for (POS_T i = -1; i <= 1; i += 2) {
-                for (POS_T j = -1; j <= 1; j += 2) {
-                    POS_T xb = -1, yb = -1;
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j) {
-                        if (mtx[i2][j2]) {
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1)) {
-                                break;
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2) {
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
-                        }
-                    }
-                }
+            else if (std::abs(score - best_score) <= eps) {
+                best_turns.push_back(turn);
+            }
+            // Окно чуть шире лучшей оценки, чтобы равные ей ходы не отсекались (в O0 окно не сужается)
+            if (optimization == Optimization::O0) {
+                continue;
+            }
+            if (color) {
+                alpha = std::max(alpha, best_score - 2 * eps);
+            }
+            else {
+                beta = std::min(beta, best_score + 2 * eps);
             }
-            break;
         }
+        const auto& best_turn = best_turns[std::uniform_int_distribution<size_t>(0, best_turns.size() - 1)(rand_eng)];
+        next_move = { best_turn };
+        next_best_state = make_turn(search_pos, best_turn);
+        stats.score = best_score;
+        return true;
+    }
 
-        // Проверяем другие ходы
-        if (!turns.empty()) {
-            have_beats = true;
-            return;
-        }
-        switch (type) {
-        case 1:
-        case 2:
-            // Проверяем пешки
-        {
-            POS_T i = ((type % 2) ? x - 1 : x + 1);
-            for (POS_T j = y - 1; j <= y + 1; j += 2) {
-                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
-                    continue;
-                turns.emplace_back(x, y, i, j);
+    /**
+     * Восстанавливает главный вариант по лучшим ходам из таблицы транспозиций.
+     * @param color Цвет бота.
+     * @param first Выбранный ход бота.
+     * @return Цепочка ходов, которую поиск считает лучшей для обеих сторон.
+     */
+    std::vector<bit_move> principal_variation(bool color, const bit_move& first) const {
+        std::vector<bit_move> pv = { first };
+        bit_position pos = make_turn(search_pos, first);
+        color = !color;
+        while (int(pv.size()) < std::max(completed_depth, 1)) {
+            tt_data entry;
+            if (!tt->probe(pos.hash ^ (color ? ZOBRIST.side : 0), entry) || !entry.has_move)
+                break;
+            move_list list;
+            pos.gen_turns(color, list);
+            const bit_move* found = nullptr;
+            for (const auto& turn : list) {
+                // Серии взятий с одними концами различаются побитыми фигурами
+                if (turn.from == entry.from && turn.to == entry.to && turn.captured == entry.captured) {
+                    found = &turn;
+                    break;
+                }
             }
-            break;
+            if (!found)
+                break;
+            pv.push_back(*found);
+            pos.do_move(*found);
+            color = !color;
         }
-        default:
-            // Проверяем дамки
-            for (POS_T i = -1; i <= 1; i += 2) {
-                for (POS_T j = -1; j <= 1; j += 2) {
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j) {
-                        if (mtx[i2][j2])
-                            break;
-                        turns.emplace_back(x, y, i2, j2);
-                    }
-                }
+        return pv;
+    }
+
+    /**
+     * Упорядочивает ходы для альфа-бета отсечения: сначала ход из таблицы транспозиций,
+     * затем взятия по количеству сбитого материала, затем ходы-убийцы и остальные по истории.
+     * @param list Список ходов.
+     * @param color Цвет игрока, который ходит.
+     * @param ply Расстояние от корня поиска.
+     * @param first Ход, который нужно проверить первым (может быть nullptr).
+     */
+    void order_turns(move_list& list, const bool color, const int ply, const bit_move* first) const {
+        int scores[MAX_TURNS];
+        for (int i = 0; i < list.size; ++i) {
+            const bit_move& turn = list[i];
+            if (first && turn.from == first->from && turn.to == first->to && turn.captured == first->captured)
+                scores[i] = ORDER_HASH;
+            else if (turn.captured)
+                scores[i] = ORDER_CAPTURE + 100 * bb_count(turn.captured & ~search_pos.kings) +
+                            300 * bb_count(turn.captured & search_pos.kings);
+            else if (turn == killers[ply][0])
+                scores[i] = ORDER_KILLER;
+            else if (turn == killers[ply][1])
+                scores[i] = ORDER_KILLER - 1;
+            else
+                scores[i] = history[color][turn.from][turn.to];
+        }
+        // Сортировка вставками: ходов немного, и она устойчива
+        for (int i = 1; i < list.size; ++i) {
+            const bit_move turn = list[i];
+            const int score = scores[i];
+            int j = i - 1;
+            for (; j >= 0 && scores[j] < score; --j) {
+                list[j + 1] = list[j];
+                scores[j + 1] = scores[j];
             }
-            break;
+            list[j + 1] = turn;
+            scores[j + 1] = score;
         }
     }
 
+    /**
+     * Учитывает тихий ход, вызвавший отсечение, в таблице истории.
+     * @param color Цвет игрока.
+     * @param turn Ход.
+     * @param depth Оставшаяся глубина (глубокие отсечения весят больше).
+     */
+    void add_history(const bool color, const bit_move& turn, const int depth) {
+        int& h = history[color][turn.from][turn.to];
+        h += depth * depth;
+        if (h >= ORDER_KILLER - 1)
+            age_history();
+    }
+
+    /**
+     * Уменьшает вдвое все значения истории, чтобы старые отсечения весили меньше новых.
+     */
+    void age_history() {
+        for (auto& by_color : history)
+            for (auto& by_from : by_color)
+                for (auto& h : by_from)
+                    h /= 2;
+    }
+
+    /**
+     * Время, прошедшее с начала текущего поиска.
+     * @return Время в миллисекундах.
+     */
+    long long elapsed_ms() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    /**
+     * Проверяет, не пора ли остановить поиск. Часы опрашиваются раз в 1024 узла,
+     * а первая глубина всегда досчитывается, чтобы у бота был ход.
+     * Помощники дополнительно останавливаются по общему флагу, когда основной поиск закончен.
+     * @return true, если поиск нужно прервать.
+     */
+    bool check_stop() {
+        if (!stopped && (++nodes & 1023) == 0 && time_limit_ms && iter_depth > 1 && elapsed_ms() >= time_limit_ms)
+            stopped = true;
+        if (!stopped && iter_depth > 1 && stop_flag->load(std::memory_order_relaxed))
+            stopped = true;
+        return stopped;
+    }
+
+    /**
+     * Выполняет ход в позиции поиска и кладет запись для отмены в стек.
+     * @param turn Ход, который нужно выполнить.
+     */
+    void do_move(const bit_move& turn) {
+        undo_stack.push_back(search_pos.do_move(turn));
+    }
+
+    /**
+     * Отменяет последний ход из стека отмены.
+     */
+    void undo_move() {
+        search_pos.undo_move(undo_stack.back());
+        undo_stack.pop_back();
+    }
+
+    /**
+     * Переводит ходы движка в координатный формат для Game и Board.
+     * @param list Список ходов движка.
+     */
+    void set_turns(const move_list& list) {
+        turns.clear();
+        for (const auto& turn : list)
+            turns.push_back(turn.to_move_pos());
+    }
+
 public:
     std::vector<move_pos> turns; // Список доступных ходов
-    bool have_beats; // Флаг наличия взятий
-    int Max_depth; // Максимальная глубина поиска
+    bool have_beats = false; // Флаг наличия взятий
+    int Max_depth = 0; // Максимальная глубина поиска
+    std::function<void(const search_progress&)> on_progress; // Вызывается из потока поиска после каждой глубины
 
 private:
     std::default_random_engine rand_eng; // Генератор случайных чисел
-    std::string scoring_mode; // Тип оценочной функции
-    std::string optimization; // Тип оптимизации
-    std::vector<move_pos> next_move; // Следующий ход
-    std::vector<std::vector<POS_T>> next_best_state; // Состояние следующего лучшего хода
-    Board* board; // Указатель на объект доски
+    Scoring scoring_mode; // Оценочная функция
+    void (Logic::*iterate_fn)(bool, int); // Итеративное углубление, специализированное под scoring_mode
+    Optimization optimization; // Профиль поиска
+    std::vector<bit_move> next_move; // Следующий ход
+    bit_position next_best_state; // Состояние следующего лучшего хода
+    bit_position search_pos; // Позиция, в которой идет перебор
+    std::vector<undo_info> undo_stack; // Стек отмены ходов перебора
+    std::vector<uint64_t> game_keys; // Отсортированные ключи позиций партии до поиска, их повторение - ничья
+    std::shared_ptr<TransTable> tt; // Таблица транспозиций, сохраняется между ходами бота и общая для помощников
+    std::shared_ptr<const Tablebase> tablebase; // База эндшпиля (nullptr, если не задана TablebasePath)
+    std::shared_ptr<const OpeningBook> book; // Дебютная книга (nullptr, если не задан OpeningBookPath)
+    bool no_random = false; // Детерминированный выбор хода (NoRandom)
+    std::shared_ptr<std::atomic<bool>> stop_flag; // Сигнал остановить поиск: помощникам - по его окончании, всем - по stop_search
+    unsigned threads_count = 1; // Число потоков поиска
+    int completed_depth = 0; // Последняя полностью просчитанная глубина
+    int quiescence_limit = 0; // Предел узлов поиска взятий из одного листа (0 - без поиска взятий)
+    int quiescence_left = 0; // Сколько узлов поиска взятий осталось для текущего листа
+    long long time_limit_ms = 0; // Бюджет времени на ход (0 - без ограничения)
+    std::chrono::steady_clock::time_point start_time; // Начало текущего поиска
+    int iter_depth = 0; // Глубина текущей итерации
+    bool stopped = false; // Поиск прерван по времени
+    uint64_t nodes = 0; // Число посещенных узлов
+    search_stats stats; // Статистика текущего поиска
+    bit_move killers[MAX_PLY][2]; // Тихие ходы, недавно вызвавшие отсечение на каждой глубине
+    int history[2][32][32] = {}; // Таблица истории отсечений [цвет][откуда][куда]
+    static const int ORDER_HASH = 1 << 30; // Приоритеты при упорядочивании ходов
+    static const int ORDER_CAPTURE = 1 << 29;
+    static const int ORDER_KILLER = 1 << 28;
+    // Фоновый поиск на время хода соперника
+    struct ponder_job {
+        bool color = false; // Цвет, за который идет поиск
+        bit_position pos; // Позиция поиска
+        std::unique_ptr<Logic> engine; // Копия Logic, которая ведет поиск
+        std::future<void> result; // Завершение поиска
+
+        // Задание можно просто отбросить: поиск останавливается, и потоки дожидаются здесь
+        ~ponder_job() {
+            if (engine)
+                engine->stop_flag->store(true);
+            if (result.valid())
+                result.wait();
+        }
+    };
+
+    std::shared_ptr<ponder_job> ponder; // Текущий фоновый поиск (nullptr, если его нет)
+    bool pondering = false; // Искать ли на время хода соперника (Pondering)
+    static constexpr double NULL_WINDOW = 1e-6; // Ширина нулевого окна для PVS
+    static constexpr double FUTILITY_MARGIN = 0.2; // Запас оценки для futility pruning
+    static constexpr double DRAW_SCORE = 1; // Оценка ничьей: по базе эндшпиля и при повторении позиции
+    static constexpr double TB_WIN = 1e6; // Оценка выигрыша черных по базе эндшпиля (минус расстояние)
+    static constexpr double TB_LOSS_STEP = 1e-5; // Оценка выигрыша белых по базе: расстояние * шаг
     Config* config; // Указатель на объект конфигурации
 };
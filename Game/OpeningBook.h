@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Ход из дебютной книги и его вес (сколько раз он был выбран поиском или принес результат в партиях)
+struct book_move
+{
+    bit_move turn;
+    uint32_t weight;
+};
+
+// Дебютная книга: ходы по ключу позиции (хэш Зобриста позиции с учетом того, чей ход).
+// Файл (все числа little-endian), отображается в память как есть:
+//   char magic[4] = "CKOB"; uint32 version; uint64 entry_count;
+//   entry_count записей по 16 байт, отсортированных по ключу:
+//     uint64 key; uint32 captured (маска побитых фигур); uint8 from; uint8 to; uint16 weight.
+// Ключи зависят от таблицы ZOBRIST, поэтому при её изменении книгу нужно построить заново.
+class OpeningBook
+{
+public:
+    // Открывает файл книги; при ошибке книга остается пустой
+    bool load(const std::string& path)
+    {
+        count = 0;
+        if (!file.open(path))
+            return false;
+        const uint8_t* raw = file.data();
+        if (file.size() < HEADER_SIZE || std::memcmp(raw, MAGIC, 4) != 0 || get<uint32_t>(raw + 4) != VERSION)
+        {
+            file.close();
+            return false;
+        }
+        const uint64_t entries = get<uint64_t>(raw + 8);
+        if (file.size() < HEADER_SIZE + entries * ENTRY_SIZE)
+        {
+            file.close();
+            return false;
+        }
+        count = size_t(entries);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Ключ позиции в книге: совпадает с ключом таблицы транспозиций Logic
+    static uint64_t position_key(const bit_position& pos, const bool color)
+    {
+        return pos.hash ^ (color ? ZOBRIST.side : 0);
+    }
+
+    /**
+     * Находит ходы книги для позиции.
+     * @param key Ключ позиции (position_key).
+     * @return Ходы в порядке убывания веса (пустой список, если позиции нет в книге).
+     */
+    std::vector<book_move> probe(const uint64_t key) const
+    {
+        std::vector<book_move> res;
+        // Двоичный поиск первой записи с ключом не меньше key
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if (entry_key(mid) < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (size_t i = lo; i < count && entry_key(i) == key; ++i)
+        {
+            const uint8_t* e = file.data() + HEADER_SIZE + i * ENTRY_SIZE;
+            res.push_back({ bit_move(e[12], e[13], get<uint32_t>(e + 8)), get<uint16_t>(e + 14) });
+        }
+        return res;
+    }
+
+private:
+    friend class OpeningBookBuilder;
+
+    static constexpr const char* MAGIC = "CKOB";
+    static const uint32_t VERSION = 1;
+    static const size_t HEADER_SIZE = 16, ENTRY_SIZE = 16;
+
+    uint64_t entry_key(const size_t i) const
+    {
+        return get<uint64_t>(file.data() + HEADER_SIZE + i * ENTRY_SIZE);
+    }
+
+    template <class T>
+    static T get(const uint8_t* raw)
+    {
+        uint64_t res = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+            res |= uint64_t(raw[i]) << (8 * i);
+        return T(res);
+    }
+
+    MappedFile file;
+    size_t count = 0;
+};
+
+// Построение дебютной книги: веса одинаковых ходов в одной позиции складываются
+class OpeningBookBuilder
+{
+public:
+    void add(const uint64_t key, const bit_move& turn, const uint32_t weight = 1)
+    {
+        moves[{ key, turn.captured, turn.from, turn.to }] += weight;
+    }
+
+    size_t size() const
+    {
+        return moves.size();
+    }
+
+    bool save(const std::string& path) const
+    {
+        std::vector<uint8_t> out(OpeningBook::HEADER_SIZE + moves.size() * OpeningBook::ENTRY_SIZE, 0);
+        std::memcpy(out.data(), OpeningBook::MAGIC, 4);
+        put<uint32_t>(&out[4], OpeningBook::VERSION);
+        put<uint64_t>(&out[8], moves.size());
+        size_t offset = OpeningBook::HEADER_SIZE;
+        // map уже упорядочен по ключу; внутри позиции сначала ходы с большим весом
+        std::vector<std::pair<move_key, uint32_t>> sorted(moves.begin(), moves.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return std::get<0>(a.first) != std::get<0>(b.first) ? std::get<0>(a.first) < std::get<0>(b.first)
+                                                                : a.second > b.second;
+        });
+        for (const auto& m : sorted)
+        {
+            put<uint64_t>(&out[offset], std::get<0>(m.first));
+            put<uint32_t>(&out[offset + 8], std::get<1>(m.first));
+            out[offset + 12] = std::get<2>(m.first);
+            out[offset + 13] = std::get<3>(m.first);
+            put<uint16_t>(&out[offset + 14], uint16_t(std::min<uint32_t>(m.second, 0xFFFF)));
+            offset += OpeningBook::ENTRY_SIZE;
+        }
+        std::ofstream fout(path, std::ios::binary);
+        fout.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size()));
+        return bool(fout);
+    }
+
+private:
+    typedef std::tuple<uint64_t, BB_T, uint8_t, uint8_t> move_key; // Ключ позиции, побитые, откуда, куда
+
+    template <class T>
+    static void put(uint8_t* raw, const T value)
+    {
+        for (size_t i = 0; i < sizeof(T); ++i)
+            raw[i] = uint8_t(uint64_t(value) >> (8 * i));
+    }
+
+    std::map<move_key, uint32_t> moves;
+};
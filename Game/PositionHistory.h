@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "Config.h"
+
+// История позиций партии для правил ничьей: ключи позиций перед каждым ходом (с учетом очереди хода,
+// как Logic::position_key) и число ходов подряд без взятий и ходов простыми.
+// Повторения позиции считаются за O(1), ход отменяется за O(1).
+class PositionHistory
+{
+public:
+    void clear()
+    {
+        turn_keys.clear();
+        quiet_before.clear();
+        counts.clear();
+        quiet = 0;
+    }
+
+    // Добавляет позицию перед ходом; progress - ход со взятием или ход простой (после него позиции не повторяются)
+    void push(const uint64_t key, const bool progress)
+    {
+        turn_keys.push_back(key);
+        quiet_before.push_back(quiet);
+        ++counts[key];
+        quiet = progress ? 0 : quiet + 1;
+    }
+
+    // Ход со взятием или ход простой: позиции до него повториться уже не могут
+    static bool is_progress(const bit_position& pos, const bit_move& turn)
+    {
+        return turn.captured || pos.at(turn.from) <= 2;
+    }
+
+    // Убирает последний ход
+    void pop()
+    {
+        auto it = counts.find(turn_keys.back());
+        if (--it->second == 0)
+            counts.erase(it);
+        quiet = quiet_before.back();
+        turn_keys.pop_back();
+        quiet_before.pop_back();
+    }
+
+    // Число сделанных ходов
+    size_t size() const
+    {
+        return turn_keys.size();
+    }
+
+    // Сколько раз позиция встречалась перед ходом
+    int count(const uint64_t key) const
+    {
+        auto it = counts.find(key);
+        return it == counts.end() ? 0 : it->second;
+    }
+
+    // Ходов подряд без взятий и ходов простыми
+    int quiet_turns() const
+    {
+        return quiet;
+    }
+
+    // Ключи позиций перед каждым ходом
+    const std::vector<uint64_t>& keys() const
+    {
+        return turn_keys;
+    }
+
+    // Ключи позиций после последнего взятия или хода простой: только они еще могут повториться
+    std::vector<uint64_t> reversible_keys() const
+    {
+        return std::vector<uint64_t>(turn_keys.end() - quiet, turn_keys.end());
+    }
+
+private:
+    std::vector<uint64_t> turn_keys;          // Ключи позиций перед каждым ходом
+    std::vector<int> quiet_before;            // quiet перед каждым ходом, для отмены
+    std::unordered_map<uint64_t, int> counts; // Сколько раз каждая позиция встречалась перед ходом
+    int quiet = 0;                            // Ходов подряд без взятий и ходов простыми
+};
+
+// Правила ничьей из раздела Game настроек, общие для Game и инструментов (match, bookgen)
+struct DrawRules
+{
+    int repetitions = 0;  // DrawRepetitions: ничья, если позиция встретилась столько раз (0 - правило отключено)
+    int quiet_turns = 0;  // DrawQuietTurns: ничья после стольких ходов без взятий и ходов простыми (0 - отключено)
+
+    DrawRules() = default;
+    explicit DrawRules(const Config& config)
+        : repetitions(config("Game", "DrawRepetitions", 3)), quiet_turns(config("Game", "DrawQuietTurns", 30))
+    {
+    }
+
+    // Наступила ли ничья перед ходом в позиции key
+    bool is_draw(const PositionHistory& history, const uint64_t key) const
+    {
+        return (repetitions && history.count(key) + 1 >= repetitions) ||
+               (quiet_turns && history.quiet_turns() >= quiet_turns);
+    }
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "Logic.h"
+
+// Поиск хода бота в отдельном потоке, чтобы окно продолжало обрабатывать события.
+// Вызывающий поток опрашивает готовность (ready, wait_for), может остановить поиск с лучшим ходом
+// последней завершенной глубины (stop) или отменить его (cancel); прогресс по глубинам приходит в on_progress,
+// а on_finish позволяет разбудить ждущий событий поток, когда результат уже готов.
+// Пока задание существует, его Logic нельзя использовать из других мест.
+class SearchJob
+{
+public:
+    /**
+     * Запускает Logic::find_best_turns в отдельном потоке.
+     * @param on_progress Вызывается из потока поиска после каждой просчитанной глубины (может быть пустым).
+     * @param on_finish Вызывается из потока поиска, когда результат готов (ready() уже true; может быть пустым).
+     */
+    SearchJob(Logic& logic, const bool color, const bit_position& pos,
+              std::function<void(const search_progress&)> on_progress = nullptr,
+              std::function<void()> on_finish = nullptr)
+        : logic(logic)
+    {
+        logic.on_progress = std::move(on_progress);
+        std::promise<std::vector<move_pos>> promise;
+        result = promise.get_future();
+        worker = std::thread([&logic, color, pos, on_finish](std::promise<std::vector<move_pos>> promise) {
+            try
+            {
+                promise.set_value(logic.find_best_turns(color, pos));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+            if (on_finish)
+                on_finish();
+        }, std::move(promise));
+    }
+
+    SearchJob(const SearchJob&) = delete;
+    SearchJob& operator=(const SearchJob&) = delete;
+
+    ~SearchJob()
+    {
+        cancel();
+    }
+
+    bool ready() const
+    {
+        return wait_for(std::chrono::milliseconds(0));
+    }
+
+    // Ждет завершения поиска не дольше timeout; true, если результат готов
+    bool wait_for(const std::chrono::milliseconds timeout) const
+    {
+        return !result.valid() || result.wait_for(timeout) == std::future_status::ready;
+    }
+
+    // Просит поиск остановиться; get вернет лучший ход последней завершенной глубины
+    void stop()
+    {
+        logic.stop_search();
+    }
+
+    // Останавливает поиск и ждет его потоки, результат отбрасывается
+    void cancel()
+    {
+        if (!result.valid())
+            return;
+        stop();
+        worker.join();
+        result = {};
+        finish();
+    }
+
+    // Лучший ход по шагам (см. Logic::find_best_turns); ждет завершения поиска
+    std::vector<move_pos> get()
+    {
+        worker.join();
+        auto turns = result.get();
+        finish();
+        return turns;
+    }
+
+private:
+    // Поиск закончен: запрос остановки, пришедший к самому концу поиска, не должен остановить следующий
+    void finish()
+    {
+        logic.stop_flag->store(false);
+        logic.on_progress = nullptr;
+    }
+
+    Logic& logic;
+    std::future<std::vector<move_pos>> result;
+    std::thread worker;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "../Models/Position.h"
+
+// Статистика одного поиска бота (одного вызова Logic::find_best_turns)
+struct search_stats
+{
+    uint64_t nodes = 0;              // Посещенные узлы всех потоков, включая поиск взятий
+    uint64_t leaf_evals = 0;         // Вызовы оценочной функции
+    uint64_t beta_cutoffs = 0;       // Альфа-бета отсечения в основном переборе
+    uint64_t first_move_cutoffs = 0; // Отсечения уже на первом проверенном ходе
+    uint64_t tt_probes = 0;          // Обращения к таблице транспозиций
+    uint64_t tt_hits = 0;            // Найденные в таблице позиции
+    uint64_t tb_hits = 0;            // Позиции, оцененные по базе эндшпиля
+    int depth = 0;                   // Последняя полностью просчитанная глубина
+    bool book_move = false;          // Ход взят из дебютной книги без перебора
+    bool ponder_hit = false;         // Ход найден фоновым поиском во время хода соперника
+    double score = 0;                // Оценка лучшего хода (с точки зрения черных)
+    double time_ms = 0;              // Время всего поиска
+    std::vector<double> depth_ms;      // Время каждой итерации основного потока, начиная с глубины 1
+    std::vector<uint64_t> depth_nodes; // Узлы каждой итерации основного потока
+    std::vector<bit_move> pv;          // Главный вариант: лучший ход и ожидаемый ответ на него и т.д.
+
+    // Доля отсечений, которые дал первый же ход (чем ближе к 1, тем лучше упорядочены ходы)
+    double first_move_cutoff_rate() const
+    {
+        return beta_cutoffs ? double(first_move_cutoffs) / beta_cutoffs : 0;
+    }
+
+    double tt_hit_rate() const
+    {
+        return tt_probes ? double(tt_hits) / tt_probes : 0;
+    }
+
+    // Эффективный коэффициент ветвления: сколько ходов в среднем перебиралось в узле,
+    // чтобы за depth полуходов набрать nodes узлов
+    double branching_factor() const
+    {
+        return depth > 0 && nodes ? std::pow(double(nodes), 1.0 / depth) : 0;
+    }
+
+    // Одна строка JSON для лога, удобная для разбора скриптами
+    std::string log_line() const
+    {
+        nlohmann::json res;
+        res["depth"] = depth;
+        res["book"] = book_move;
+        res["ponder_hit"] = ponder_hit;
+        res["score"] = score;
+        res["time_ms"] = time_ms;
+        res["nodes"] = nodes;
+        res["nps"] = time_ms > 0 ? uint64_t(nodes * 1000 / time_ms) : 0;
+        res["leaf_evals"] = leaf_evals;
+        res["beta_cutoffs"] = beta_cutoffs;
+        res["first_move_cutoff_rate"] = first_move_cutoff_rate();
+        res["tt_hit_rate"] = tt_hit_rate();
+        res["tb_hits"] = tb_hits;
+        res["branching_factor"] = branching_factor();
+        res["depth_ms"] = depth_ms;
+        res["depth_nodes"] = depth_nodes;
+        std::vector<std::string> pv_names;
+        for (const auto& turn : pv)
+            pv_names.push_back(turn.name());
+        res["pv"] = pv_names;
+        return res.dump();
+    }
+};
+
+// Прогресс поиска после каждой полностью просчитанной глубины (для SearchJob)
+struct search_progress
+{
+    int depth = 0;       // Просчитанная глубина
+    double score = 0;    // Оценка лучшего хода (с точки зрения черных)
+    uint64_t nodes = 0;  // Узлы основного потока с начала поиска
+    double time_ms = 0;  // Время с начала поиска
+    bit_move best;       // Лучший ход на этой глубине
+};
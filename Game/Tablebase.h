@@ -0,0 +1,460 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Результат позиции из базы эндшпиля для стороны, которая ходит
+enum class TbResult : uint8_t
+{
+    DRAW, // Никто не может форсированно выиграть
+    WIN,  // Сторона, которая ходит, выигрывает
+    LOSS  // Сторона, которая ходит, проигрывает
+};
+
+struct tb_entry
+{
+    TbResult result = TbResult::DRAW;
+    int distance = 0; // Число полуходов до конца партии при лучшей игре обеих сторон
+};
+
+// База эндшпиля: точные результаты всех позиций, где фигур не больше max_pieces.
+// Позиции одного соотношения материала (белые и черные пешки и дамки) хранятся одной таблицей,
+// номер позиции в таблице - комбинаторный индекс клеток каждой группы фигур.
+// На позицию и сторону, которая ходит, - один байт: 0 - ничья, 1..127 - выигрыш за столько полуходов,
+// 128 + d - проигрыш через d полуходов.
+//
+// Файл: заголовок, каталог таблиц и сами таблицы подряд (все числа little-endian):
+//   char magic[4] = "CKTB"; uint32 version; uint32 max_pieces; uint32 table_count;
+//   table_count записей каталога: uint8 white_pawns, black_pawns, white_kings, black_kings; uint32 reserved;
+//                                 uint64 offset (от начала файла); uint64 size (байт);
+//   таблица: size байт, индекс (номер позиции * 2 + цвет, который ходит).
+// Файл отображается в память как есть, поэтому загрузка мгновенная, а читаются только страницы
+// с позициями, которые действительно встретились в переборе.
+class Tablebase
+{
+public:
+    static const int MAX_GROUP = 7; // Больше фигур одного типа база не поддерживает
+
+    // Открывает файл базы (отображением в память); при ошибке база остается пустой
+    bool load(const std::string& path)
+    {
+        clear();
+        if (!file.open(path) || !parse(file.data(), file.size()))
+        {
+            clear();
+            return false;
+        }
+        bytes = file.data();
+        return true;
+    }
+
+    bool save(const std::string& path) const
+    {
+        std::ofstream fout(path, std::ios::binary);
+        fout.write(reinterpret_cast<const char*>(built.data()), std::streamsize(built.size()));
+        return bool(fout);
+    }
+
+    void clear()
+    {
+        file.close();
+        built.clear();
+        bytes = nullptr;
+        pieces_limit = 0;
+        for (auto& t : tables)
+            t = table_ref();
+    }
+
+    // Наибольшее число фигур в позициях базы (0 - база не загружена)
+    int max_pieces() const
+    {
+        return pieces_limit;
+    }
+
+    /**
+     * Ищет позицию в базе.
+     * @param pos Позиция.
+     * @param color Цвет, который ходит.
+     * @param out Результат для стороны, которая ходит.
+     * @return false, если такого материала в базе нет.
+     */
+    bool probe(const bit_position& pos, const bool color, tb_entry& out) const
+    {
+        if (bb_count(pos.white | pos.black) > pieces_limit)
+            return false;
+        if (!pos.pieces(color))
+        {
+            out = { TbResult::LOSS, 0 };
+            return true;
+        }
+        const material m = material::of(pos);
+        if (!m.valid())
+            return false;
+        const table_ref& t = tables[m.key()];
+        if (!t.size)
+            return false;
+        out = decode(bytes[t.offset + index(pos, m) * 2 + color]);
+        return true;
+    }
+
+    /**
+     * Строит базу для всех позиций, где не больше max_pieces фигур, ретроградным анализом.
+     * Таблицы считаются от меньшего материала к большему, поэтому ходы со взятием и превращением
+     * всегда ведут в уже посчитанные таблицы.
+     * @param max_pieces Наибольшее число фигур.
+     * @param progress Вызывается после каждой таблицы (материал, число позиций).
+     */
+    void build(const int max_pieces, const std::function<void(const std::string&, uint64_t)>& progress = nullptr)
+    {
+        clear();
+        std::vector<material> order;
+        for (int total = 2; total <= max_pieces; ++total)
+        {
+            // Сначала меньше пешек: превращение ведет в таблицу с тем же числом фигур, но меньшим числом пешек
+            for (int pawns = 0; pawns <= total; ++pawns)
+            {
+                for (int wp = 0; wp <= pawns; ++wp)
+                {
+                    for (int wk = 0; wk <= total - pawns; ++wk)
+                    {
+                        const material m{ uint8_t(wp), uint8_t(pawns - wp), uint8_t(wk), uint8_t(total - pawns - wk) };
+                        if (m.valid() && m.white() && m.black())
+                            order.push_back(m);
+                    }
+                }
+            }
+        }
+
+        // Заголовок и каталог
+        built.assign(HEADER_SIZE + order.size() * ENTRY_SIZE, 0);
+        std::memcpy(built.data(), MAGIC, 4);
+        put<uint32_t>(4, VERSION);
+        put<uint32_t>(8, uint32_t(max_pieces));
+        put<uint32_t>(12, uint32_t(order.size()));
+        pieces_limit = max_pieces;
+
+        int max_distance = 0;
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const material m = order[i];
+            table_ref& t = tables[m.key()];
+            t.offset = built.size();
+            t.size = m.positions() * 2;
+            built.resize(t.offset + t.size, 0);
+            bytes = built.data();
+            const size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+            built[entry] = m.wp;
+            built[entry + 1] = m.bp;
+            built[entry + 2] = m.wk;
+            built[entry + 3] = m.bk;
+            put<uint64_t>(entry + 8, t.offset);
+            put<uint64_t>(entry + 16, t.size);
+            max_distance = std::max(max_distance, build_table(m, t, max_distance));
+            if (progress)
+                progress(m.name(), m.positions());
+        }
+    }
+
+private:
+    // Соотношение материала: число пешек и дамок каждого цвета
+    struct material
+    {
+        uint8_t wp, bp, wk, bk;
+
+        static material of(const bit_position& pos)
+        {
+            return { uint8_t(bb_count(pos.white & ~pos.kings)), uint8_t(bb_count(pos.black & ~pos.kings)),
+                     uint8_t(bb_count(pos.white & pos.kings)), uint8_t(bb_count(pos.black & pos.kings)) };
+        }
+
+        bool valid() const
+        {
+            return wp <= MAX_GROUP && bp <= MAX_GROUP && wk <= MAX_GROUP && bk <= MAX_GROUP;
+        }
+
+        int white() const
+        {
+            return wp + wk;
+        }
+
+        int black() const
+        {
+            return bp + bk;
+        }
+
+        int key() const
+        {
+            return wp | (bp << 3) | (wk << 6) | (bk << 9);
+        }
+
+        uint64_t positions() const
+        {
+            return binom(PAWN_SQUARES, wp) * binom(PAWN_SQUARES, bp) * binom(32, wk) * binom(32, bk);
+        }
+
+        std::string name() const
+        {
+            return std::string(wk, 'K') + std::string(wp, 'P') + "v" + std::string(bk, 'K') + std::string(bp, 'P');
+        }
+    };
+
+    struct table_ref
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    static constexpr const char* MAGIC = "CKTB";
+    static const uint32_t VERSION = 1;
+    static const size_t HEADER_SIZE = 16, ENTRY_SIZE = 24;
+    static const int PAWN_SQUARES = 28; // Пешка не стоит на своей последней строке
+    static const uint8_t LOSS_BASE = 128;
+
+    static uint64_t binom(const int n, const int k)
+    {
+        static const auto table = [] {
+            std::vector<std::vector<uint64_t>> c(33, std::vector<uint64_t>(MAX_GROUP + 1, 0));
+            for (int i = 0; i <= 32; ++i)
+            {
+                c[i][0] = 1;
+                for (int j = 1; j <= MAX_GROUP && j <= i; ++j)
+                    c[i][j] = c[i - 1][j - 1] + (j < i ? c[i - 1][j] : 0);
+            }
+            return c;
+        }();
+        return (k < 0 || n < 0 || k > MAX_GROUP) ? 0 : table[n][k];
+    }
+
+    // Номер набора клеток группы фигур (сочетания в колексикографическом порядке).
+    // Клетки пешек отсчитываются без последней для них строки.
+    static uint64_t rank(BB_T squares, const int shift)
+    {
+        uint64_t res = 0;
+        for (int i = 1; squares; ++i)
+            res += binom(bb_pop(squares) - shift, i);
+        return res;
+    }
+
+    static BB_T unrank(uint64_t r, const int k, const int shift)
+    {
+        BB_T res = 0;
+        for (int i = k; i >= 1; --i)
+        {
+            int c = i - 1;
+            while (binom(c + 1, i) <= r)
+                ++c;
+            r -= binom(c, i);
+            res |= BB_T(1) << (c + shift);
+        }
+        return res;
+    }
+
+    // Сдвиг номеров клеток пешек: белые пешки не стоят на строке 0, черные - на строке 7
+    static const int WHITE_PAWN_SHIFT = 4, BLACK_PAWN_SHIFT = 0;
+
+    static uint64_t index(const bit_position& pos, const material& m)
+    {
+        uint64_t res = rank(pos.white & ~pos.kings, WHITE_PAWN_SHIFT);
+        res = res * binom(PAWN_SQUARES, m.bp) + rank(pos.black & ~pos.kings, BLACK_PAWN_SHIFT);
+        res = res * binom(32, m.wk) + rank(pos.white & pos.kings, 0);
+        res = res * binom(32, m.bk) + rank(pos.black & pos.kings, 0);
+        return res;
+    }
+
+    // Позиция по номеру; false, если фигуры разных групп попали на одну клетку
+    static bool position_at(uint64_t idx, const material& m, bit_position& pos)
+    {
+        const uint64_t n_bk = binom(32, m.bk), n_wk = binom(32, m.wk), n_bp = binom(PAWN_SQUARES, m.bp);
+        const BB_T bk = unrank(idx % n_bk, m.bk, 0);
+        idx /= n_bk;
+        const BB_T wk = unrank(idx % n_wk, m.wk, 0);
+        idx /= n_wk;
+        const BB_T bp = unrank(idx % n_bp, m.bp, BLACK_PAWN_SHIFT);
+        idx /= n_bp;
+        const BB_T wp = unrank(idx, m.wp, WHITE_PAWN_SHIFT);
+        if (bb_count(wp | bp | wk | bk) != m.wp + m.bp + m.wk + m.bk)
+            return false;
+        pos = bit_position::from_masks(wp | wk, bp | bk, wk | bk);
+        return true;
+    }
+
+    static tb_entry decode(const uint8_t v)
+    {
+        if (v == 0)
+            return { TbResult::DRAW, 0 };
+        if (v < LOSS_BASE)
+            return { TbResult::WIN, v };
+        return { TbResult::LOSS, v - LOSS_BASE };
+    }
+
+    static uint8_t encode_win(const int distance)
+    {
+        return uint8_t(std::min(distance, int(LOSS_BASE) - 1));
+    }
+
+    static uint8_t encode_loss(const int distance)
+    {
+        return uint8_t(LOSS_BASE + std::min(distance, 127));
+    }
+
+    // Нерешенная позиция таблицы и то, что известно о её ходах
+    struct open_item
+    {
+        uint64_t item;      // Номер позиции * 2 + цвет, который ходит
+        size_t first_child; // Ходы в позиции той же таблицы: children[first_child, first_child + child_count)
+        uint32_t child_count;
+        int other_loss;     // Лучший ход в другую таблицу с проигрышем соперника (-1 - нет такого)
+        int other_win;      // Самый дальний выигрыш соперника среди ходов в другие таблицы
+        bool other_all_win; // Все ходы в другие таблицы ведут к выигрышу соперника
+    };
+
+    /**
+     * Считает одну таблицу. На шаге n находятся выигрыши и проигрыши ровно за n полуходов:
+     * выигрыш - если есть ход в проигрыш соперника не дальше n - 1, проигрыш - если все ходы ведут
+     * в выигрыш соперника не дальше n - 1. Что осталось нерешенным, когда шаги ничего не меняют, - ничья.
+     * Ходы каждой позиции генерируются один раз: результаты ходов в другие (уже посчитанные) таблицы
+     * сворачиваются сразу, а для ходов внутри таблицы запоминаются номера позиций.
+     * @param m Материал таблицы.
+     * @param t Место таблицы в built.
+     * @param other_distance Наибольшее расстояние в уже посчитанных таблицах.
+     * @return Наибольшее расстояние в этой таблице.
+     */
+    int build_table(const material& m, const table_ref& t, const int other_distance)
+    {
+        const int m_key = m.key();
+        std::vector<open_item> open;
+        std::vector<uint64_t> children;
+        for (uint64_t idx = 0; idx < m.positions(); ++idx)
+        {
+            bit_position pos;
+            if (!position_at(idx, m, pos))
+                continue;
+            for (int color = 0; color < 2; ++color)
+            {
+                move_list list;
+                pos.gen_turns(color, list);
+                if (list.empty())
+                {
+                    built[t.offset + idx * 2 + color] = encode_loss(0); // Нет ходов - проигрыш
+                    continue;
+                }
+                open_item o{ idx * 2 + color, children.size(), 0, -1, 0, true };
+                for (const auto& turn : list)
+                {
+                    bit_position next = pos;
+                    next.do_move(turn);
+                    const material child_m = material::of(next);
+                    if (next.pieces(!color) && child_m.key() == m_key)
+                    {
+                        children.push_back(index(next, m) * 2 + !color);
+                        ++o.child_count;
+                        continue;
+                    }
+                    tb_entry child;
+                    probe(next, !color, child);
+                    if (child.result == TbResult::LOSS && (o.other_loss == -1 || child.distance < o.other_loss))
+                        o.other_loss = child.distance;
+                    if (child.result == TbResult::WIN)
+                        o.other_win = std::max(o.other_win, child.distance);
+                    else
+                        o.other_all_win = false;
+                }
+                open.push_back(o);
+            }
+        }
+
+        int max_distance = 0;
+        std::vector<std::pair<uint64_t, uint8_t>> solved;
+        const uint8_t* table = &built[t.offset];
+        for (int n = 1; !open.empty() && n < int(LOSS_BASE); ++n)
+        {
+            solved.clear();
+            size_t kept = 0;
+            for (const open_item& o : open)
+            {
+                int best_loss = (o.other_loss != -1 && o.other_loss <= n - 1) ? o.other_loss : -1;
+                bool all_win = o.other_all_win && o.other_win <= n - 1;
+                int worst_win = o.other_win;
+                for (size_t c = o.first_child; c < o.first_child + o.child_count; ++c)
+                {
+                    const tb_entry child = decode(table[children[c]]);
+                    if (child.result == TbResult::LOSS && child.distance <= n - 1 &&
+                        (best_loss == -1 || child.distance < best_loss))
+                        best_loss = child.distance;
+                    if (child.result != TbResult::WIN || child.distance > n - 1)
+                        all_win = false;
+                    else
+                        worst_win = std::max(worst_win, child.distance);
+                }
+                if (best_loss != -1)
+                    solved.emplace_back(o.item, encode_win(best_loss + 1));
+                else if (all_win)
+                    solved.emplace_back(o.item, encode_loss(worst_win + 1));
+                else
+                    open[kept++] = o;
+            }
+            open.resize(kept);
+            // Записываем после шага, чтобы на шаге n видеть только результаты до n - 1
+            for (const auto& s : solved)
+            {
+                built[t.offset + s.first] = s.second;
+                max_distance = std::max(max_distance, decode(s.second).distance);
+            }
+            if (solved.empty() && n > other_distance + 1)
+                break;
+        }
+        return max_distance;
+    }
+
+    // Проверяет заголовок и каталог; сами таблицы не читаются
+    bool parse(const uint8_t* raw, const size_t size)
+    {
+        if (size < HEADER_SIZE || std::memcmp(raw, MAGIC, 4) != 0)
+            return false;
+        if (get<uint32_t>(raw, 4) != VERSION)
+            return false;
+        const uint32_t max_pieces = get<uint32_t>(raw, 8), count = get<uint32_t>(raw, 12);
+        if (size < HEADER_SIZE + uint64_t(count) * ENTRY_SIZE)
+            return false;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+            const material m{ raw[entry], raw[entry + 1], raw[entry + 2], raw[entry + 3] };
+            table_ref t{ get<uint64_t>(raw, entry + 8), get<uint64_t>(raw, entry + 16) };
+            if (!m.valid() || t.size != m.positions() * 2 || t.offset + t.size > size)
+                return false;
+            tables[m.key()] = t;
+        }
+        pieces_limit = int(max_pieces);
+        return true;
+    }
+
+    template <class T>
+    void put(const size_t offset, const T value)
+    {
+        for (size_t i = 0; i < sizeof(T); ++i)
+            built[offset + i] = uint8_t(uint64_t(value) >> (8 * i));
+    }
+
+    template <class T>
+    static T get(const uint8_t* raw, const size_t offset)
+    {
+        uint64_t res = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+            res |= uint64_t(raw[offset + i]) << (8 * i);
+        return T(res);
+    }
+
+    MappedFile file; // Открытый файл базы
+    std::vector<uint8_t> built; // База, построенная build, до сохранения в файл
+    const uint8_t* bytes = nullptr; // Содержимое базы: отображенный файл или built
+    table_ref tables[1 << 12]; // Таблицы по ключу материала
+    int pieces_limit = 0;
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#else
+#include <SDL.h>
+#include <SDL_image.h>
+#endif
+
+// Изображения игры
+enum class Sprite
+{
+    BOARD,
+    WHITE_PIECE,
+    BLACK_PIECE,
+    WHITE_QUEEN,
+    BLACK_QUEEN,
+    BACK,
+    REPLAY,
+    DRAW,
+    WHITE_WINS,
+    BLACK_WINS,
+    COUNT
+};
+
+// Кэш текстур: все изображения из Textures/ загружаются и декодируются один раз при запуске
+// и живут, пока жив рендерер, поэтому при отрисовке нет ни чтения файлов, ни декодирования PNG.
+// Фигуры и кнопки, которые рисуются в каждом кадре, собраны в один атлас, чтобы их копирования
+// шли из одной текстуры; доска и картинки результата большие и остаются отдельными текстурами.
+// Атлас собирается в памяти и загружается как обычная текстура, поэтому он переживает SDL_RENDER_TARGETS_RESET;
+// после SDL_RENDER_DEVICE_RESET все текстуры нужно загрузить заново (Board::render_device_reset).
+class TextureCache
+{
+public:
+    TextureCache() = default;
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    ~TextureCache()
+    {
+        clear();
+    }
+
+    // Загружает все изображения из каталога dir; при ошибке failed_path - файл, который не удалось загрузить
+    bool load(SDL_Renderer* ren, const std::string& dir, std::string& failed_path)
+    {
+        clear();
+        // Сначала проверяем, что все файлы на месте, чтобы не упасть посреди игры
+        std::vector<SDL_Surface*> images(size_t(Sprite::COUNT), nullptr);
+        bool ok = true;
+        for (size_t i = 0; i < images.size() && ok; ++i)
+        {
+            const std::string path = dir + FILES[i];
+            SDL_Surface* loaded = IMG_Load(path.c_str());
+            images[i] = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+            if (loaded)
+                SDL_FreeSurface(loaded);
+            if (!images[i])
+            {
+                failed_path = path;
+                ok = false;
+            }
+        }
+        if (ok)
+            ok = make_textures(ren, images, failed_path);
+        for (auto image : images)
+        {
+            if (image)
+                SDL_FreeSurface(image);
+        }
+        if (!ok)
+            clear();
+        return ok;
+    }
+
+    // Рисует изображение в прямоугольник окна (nullptr - на всё окно)
+    void draw(SDL_Renderer* ren, const Sprite sprite, const SDL_Rect* dst) const
+    {
+        const sprite_info& info = sprites[size_t(sprite)];
+        SDL_RenderCopy(ren, info.texture, &info.src, dst);
+    }
+
+    void clear()
+    {
+        for (auto texture : textures)
+            SDL_DestroyTexture(texture);
+        textures.clear();
+        for (auto& info : sprites)
+            info = sprite_info();
+    }
+
+private:
+    struct sprite_info
+    {
+        SDL_Texture* texture = nullptr;
+        SDL_Rect src{ 0, 0, 0, 0 };  // Область изображения в текстуре
+    };
+
+    // Собирает атлас из маленьких изображений, большие загружает отдельными текстурами
+    bool make_textures(SDL_Renderer* ren, const std::vector<SDL_Surface*>& images, std::string& failed_path)
+    {
+        // Раскладка атласа полками: изображения по убыванию высоты, ряд за рядом шириной не больше ATLAS_WIDTH
+        std::vector<size_t> in_atlas;
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            if (images[i]->w <= ATLAS_MAX_SPRITE && images[i]->h <= ATLAS_MAX_SPRITE)
+                in_atlas.push_back(i);
+        }
+        std::sort(in_atlas.begin(), in_atlas.end(), [&images](const size_t a, const size_t b) {
+            return images[a]->h > images[b]->h;
+        });
+        int x = 0, y = 0, shelf = 0, atlas_w = 0;
+        for (const size_t i : in_atlas)
+        {
+            if (x + images[i]->w > ATLAS_WIDTH)
+            {
+                x = 0;
+                y += shelf + ATLAS_PADDING;
+                shelf = 0;
+            }
+            sprites[i].src = { x, y, images[i]->w, images[i]->h };
+            x += images[i]->w + ATLAS_PADDING;
+            shelf = std::max(shelf, images[i]->h);
+            atlas_w = std::max(atlas_w, x);
+        }
+
+        if (!in_atlas.empty())
+        {
+            // Прозрачные промежутки между изображениями не дают соседям просвечивать при масштабировании
+            SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlas_w, y + shelf, 32, SDL_PIXELFORMAT_RGBA32);
+            if (!atlas)
+            {
+                failed_path = "texture atlas";
+                return false;
+            }
+            for (const size_t i : in_atlas)
+            {
+                // Пиксели копируются как есть, вместе с прозрачностью
+                SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+                SDL_Rect dst = sprites[i].src;
+                SDL_BlitSurface(images[i], nullptr, atlas, &dst);
+            }
+            SDL_Texture* texture = add_texture(ren, atlas);
+            SDL_FreeSurface(atlas);
+            if (!texture)
+            {
+                failed_path = "texture atlas";
+                return false;
+            }
+            for (const size_t i : in_atlas)
+                sprites[i].texture = texture;
+        }
+
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            if (sprites[i].texture)
+                continue;
+            sprites[i].texture = add_texture(ren, images[i]);
+            sprites[i].src = { 0, 0, images[i]->w, images[i]->h };
+            if (!sprites[i].texture)
+            {
+                failed_path = FILES[i];
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SDL_Texture* add_texture(SDL_Renderer* ren, SDL_Surface* image)
+    {
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(ren, image);
+        if (texture)
+        {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            textures.push_back(texture);
+        }
+        return texture;
+    }
+
+    // Файлы изображений в порядке Sprite
+    static constexpr const char* FILES[size_t(Sprite::COUNT)] = {
+        "board.png",       "piece_white.png", "piece_black.png", "queen_white.png", "queen_black.png",
+        "back.png",        "replay.png",      "draw.png",        "white_wins.png",  "black_wins.png",
+    };
+    static const int ATLAS_WIDTH = 2048;       // Ширина атласа: такие текстуры поддерживает любой рендерер
+    static const int ATLAS_MAX_SPRITE = 1024;  // Изображения больше этого в атлас не попадают
+    static const int ATLAS_PADDING = 2;        // Промежуток между изображениями в атласе
+
+    sprite_info sprites[size_t(Sprite::COUNT)];
+    std::vector<SDL_Texture*> textures;  // Все созданные текстуры (атлас и отдельные)
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "../Models/Position.h"
+
+// Тип оценки, сохраненной в таблице
+enum class Bound : uint8_t
+{
+    EXACT, // Точная оценка
+    LOWER, // Оценка не меньше сохраненной (было отсечение сверху)
+    UPPER  // Оценка не больше сохраненной (ни один ход не улучшил alpha)
+};
+
+// Распакованная запись таблицы
+struct tt_data
+{
+    double score = 0;
+    int depth = 0;
+    Bound bound = Bound::EXACT;
+    bool has_move = false;
+    uint8_t from = 0, to = 0; // Лучший ход (начальная и конечная клетки)
+    BB_T captured = 0;        // Побитые лучшим ходом фигуры: различает серии взятий с одними концами
+};
+
+// Таблица транспозиций фиксированного размера.
+// Запись - три 64-битных слова: ключ хранится как key ^ data ^ score, поэтому
+// запись, порванная одновременной записью из разных потоков, просто не пройдет проверку ключа.
+class TransTable
+{
+public:
+    TransTable(const size_t size_mb = 0)
+    {
+        resize(size_mb);
+    }
+
+    // Выделяет таблицу размером не больше size_mb мегабайт (число записей - степень двойки)
+    void resize(const size_t size_mb)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(entry) <= size_mb * 1024 * 1024)
+            count *= 2;
+        size = size_mb ? count : 0;
+        table.reset(size ? new entry[size] : nullptr);
+        clear();
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            table[i].key.store(0, std::memory_order_relaxed);
+            table[i].data.store(0, std::memory_order_relaxed);
+            table[i].score.store(0, std::memory_order_relaxed);
+        }
+        age = 0;
+    }
+
+    // Вызывается перед каждым новым поиском, чтобы старые записи вытеснялись в первую очередь
+    void new_search()
+    {
+        age = (age + 1) & AGE_MASK;
+    }
+
+    bool probe(const uint64_t key, tt_data& out) const
+    {
+        if (!size)
+            return false;
+        const entry& e = table[key & (size - 1)];
+        const uint64_t data = e.data.load(std::memory_order_relaxed);
+        const uint64_t score = e.score.load(std::memory_order_relaxed);
+        if ((e.key.load(std::memory_order_relaxed) ^ data ^ score) != key)
+            return false;
+        out = unpack(data, score);
+        return true;
+    }
+
+    void store(const uint64_t key, const double score, const int depth, const Bound bound, const bit_move* turn)
+    {
+        if (!size)
+            return;
+        entry& e = table[key & (size - 1)];
+        const uint64_t old_data = e.data.load(std::memory_order_relaxed);
+        const uint64_t old_score = e.score.load(std::memory_order_relaxed);
+        const bool same = (e.key.load(std::memory_order_relaxed) ^ old_data ^ old_score) == key;
+        // Замещаем запись, если она от прошлого поиска, про другую позицию или менее глубокая
+        if (old_data && ((old_data >> AGE_SHIFT) & AGE_MASK) == age && !same &&
+            int((old_data >> DEPTH_SHIFT) & 0xFF) > depth)
+            return;
+        uint64_t data = pack(depth, bound, turn);
+        if (same && !turn)
+            data |= old_data & MOVE_BITS; // Сохраняем прежний лучший ход
+        uint64_t score_bits;
+        std::memcpy(&score_bits, &score, sizeof(score_bits));
+        e.key.store(key ^ data ^ score_bits, std::memory_order_relaxed);
+        e.data.store(data, std::memory_order_relaxed);
+        e.score.store(score_bits, std::memory_order_relaxed);
+    }
+
+private:
+    struct entry
+    {
+        std::atomic<uint64_t> key{ 0 };
+        std::atomic<uint64_t> data{ 0 };
+        std::atomic<uint64_t> score{ 0 }; // Биты оценки (double)
+    };
+
+    // Упаковка записи: [0..31] побитые фигуры, [32..39] глубина, [40..41] тип оценки, [42..46] откуда,
+    // [47..51] куда, [52] есть ли ход, [53..58] поколение.
+    // Оценка хранится отдельным словом как double без округления: поиск сравнивает оценки
+    // с точностью 1e-6 (NULL_WINDOW, выбор среди равных ходов в корне), а соотношения фигур бывают больше 16,
+    // где шаг float уже крупнее, и округленная оценка могла бы перейти через нулевое окно.
+    static const int DEPTH_SHIFT = 32, BOUND_SHIFT = 40, FROM_SHIFT = 42, TO_SHIFT = 47;
+    static const int MOVE_FLAG_SHIFT = 52, AGE_SHIFT = 53;
+    static const uint64_t AGE_MASK = 0x3F;
+    static const uint64_t MOVE_BITS = (uint64_t(0x7FF) << FROM_SHIFT) | 0xFFFFFFFFull;
+
+    uint64_t pack(const int depth, const Bound bound, const bit_move* turn) const
+    {
+        uint64_t data = uint64_t(depth < 0 ? 0 : (depth > 255 ? 255 : depth)) << DEPTH_SHIFT;
+        data |= uint64_t(bound) << BOUND_SHIFT;
+        if (turn)
+        {
+            data |= uint64_t(turn->captured);
+            data |= uint64_t(turn->from) << FROM_SHIFT;
+            data |= uint64_t(turn->to) << TO_SHIFT;
+            data |= uint64_t(1) << MOVE_FLAG_SHIFT;
+        }
+        data |= uint64_t(age) << AGE_SHIFT;
+        return data;
+    }
+
+    static tt_data unpack(const uint64_t data, const uint64_t score_bits)
+    {
+        tt_data res;
+        std::memcpy(&res.score, &score_bits, sizeof(res.score));
+        res.depth = int((data >> DEPTH_SHIFT) & 0xFF);
+        res.bound = Bound((data >> BOUND_SHIFT) & 3);
+        res.captured = BB_T(data);
+        res.from = uint8_t((data >> FROM_SHIFT) & 0x1F);
+        res.to = uint8_t((data >> TO_SHIFT) & 0x1F);
+        res.has_move = (data >> MOVE_FLAG_SHIFT) & 1;
+        return res;
+    }
+
+    std::unique_ptr<entry[]> table;
+    size_t size = 0;
+    uint64_t age = 0;
+};
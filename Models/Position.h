@@ -0,0 +1,693 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Move.h"
+
+// Битовая маска 32 тёмных клеток доски.
+// Клетка (x, y) имеет номер x * 4 + y / 2: x - строка (0 - сторона черных), y - столбец.
+typedef uint32_t BB_T;
+
+const BB_T BB_ROW_0 = 0x0000000F;     // Первая строка (превращение белых)
+const BB_T BB_ROW_7 = 0xF0000000;     // Последняя строка (превращение черных)
+const BB_T BB_EVEN_ROWS = 0x0F0F0F0F; // Строки 0, 2, 4, 6 (тёмные клетки в нечетных столбцах)
+const BB_T BB_ODD_ROWS = 0xF0F0F0F0;  // Строки 1, 3, 5, 7 (тёмные клетки в четных столбцах)
+const BB_T BB_COL_0 = 0x11111111;     // Крайние левые клетки строк
+const BB_T BB_COL_3 = 0x88888888;     // Крайние правые клетки строк
+
+// Направления по диагонали: вверх-влево, вверх-вправо, вниз-влево, вниз-вправо.
+// Противоположное направление к d равно 3 - d.
+const int DIR_UL = 0, DIR_UR = 1, DIR_DL = 2, DIR_DR = 3;
+
+const int MAX_TURNS = 160; // Верхняя граница числа ходов из одной позиции (12 дамок по 13 клеток)
+
+// Номер младшего установленного бита
+inline int bb_lsb(const BB_T b)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, b);
+    return int(i);
+#else
+    return __builtin_ctz(b);
+#endif
+}
+
+// Количество установленных битов
+inline int bb_count(const BB_T b)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(b));
+#else
+    return __builtin_popcount(b);
+#endif
+}
+
+// Извлекает младший бит из маски и возвращает его номер
+inline int bb_pop(BB_T& b)
+{
+    const int s = bb_lsb(b);
+    b &= b - 1;
+    return s;
+}
+
+// Сдвигает все клетки маски на одну клетку в направлении dir.
+// Клетки, уходящие за край доски, отбрасываются.
+inline BB_T bb_step(const BB_T b, const int dir)
+{
+    switch (dir)
+    {
+    case DIR_UL:
+        return ((b & BB_EVEN_ROWS & ~BB_ROW_0) >> 4) | ((b & BB_ODD_ROWS & ~BB_COL_0) >> 5);
+    case DIR_UR:
+        return ((b & BB_EVEN_ROWS & ~BB_ROW_0 & ~BB_COL_3) >> 3) | ((b & BB_ODD_ROWS) >> 4);
+    case DIR_DL:
+        return ((b & BB_EVEN_ROWS) << 4) | ((b & BB_ODD_ROWS & ~BB_COL_0 & ~BB_ROW_7) << 3);
+    default:
+        return ((b & BB_EVEN_ROWS & ~BB_COL_3) << 5) | ((b & BB_ODD_ROWS & ~BB_ROW_7) << 4);
+    }
+}
+
+// Перевод номера клетки в координаты доски и обратно
+inline POS_T sq_x(const int sq)
+{
+    return POS_T(sq / 4);
+}
+
+inline POS_T sq_y(const int sq)
+{
+    return POS_T(2 * (sq % 4) + (sq / 4 % 2 == 0));
+}
+
+// Возвращает -1 для светлых клеток и клеток вне доски
+inline int sq_index(const POS_T x, const POS_T y)
+{
+    if (x < 0 || x > 7 || y < 0 || y > 7 || (x + y) % 2 == 0)
+        return -1;
+    return x * 4 + y / 2;
+}
+
+// Ключи Зобриста: по одному на каждый код фигуры (1-4) в каждой клетке и ключ хода черных
+struct zobrist_keys
+{
+    uint64_t piece[4][32];
+    uint64_t side;
+};
+
+// Детерминированная генерация ключей (splitmix64), чтобы хэши совпадали между запусками
+constexpr zobrist_keys make_zobrist_keys()
+{
+    zobrist_keys keys{};
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state]() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    for (int t = 0; t < 4; ++t)
+        for (int sq = 0; sq < 32; ++sq)
+            keys.piece[t][sq] = next();
+    keys.side = next();
+    return keys;
+}
+
+inline constexpr zobrist_keys ZOBRIST = make_zobrist_keys();
+
+// Компактный ход движка: откуда, куда и маска побитых фигур.
+// Серия взятий хранится как один ход: маска содержит все побитые фигуры, to - последнюю клетку.
+// Конструктор по умолчанию не обнуляет поля, чтобы списки ходов создавались без затрат;
+// bit_move() / bit_move{} дают нулевой ход.
+struct bit_move
+{
+    BB_T captured;     // Маска побитых фигур (0 - тихий ход)
+    uint8_t from;      // Номер начальной клетки
+    uint8_t to;        // Номер конечной клетки
+    bool promote;      // Пешка становится дамкой (в том числе посреди серии взятий)
+
+    bit_move() = default;
+    bit_move(const int from, const int to, const BB_T captured = 0, const bool promote = false)
+        : captured(captured), from(uint8_t(from)), to(uint8_t(to)), promote(promote)
+    {
+    }
+
+    // Перевод одиночного шага в ход с координатами, которым пользуются Game и Board.
+    // Для серии взятий используйте bit_position::expand.
+    move_pos to_move_pos() const
+    {
+        if (!captured)
+            return move_pos(sq_x(from), sq_y(from), sq_x(to), sq_y(to));
+        const int b = bb_lsb(captured);
+        return move_pos(sq_x(from), sq_y(from), sq_x(to), sq_y(to), sq_x(b), sq_y(b));
+    }
+
+    // Запись хода в шашечной нотации: "c3-d4" для тихого хода, "c3:e5" для взятия
+    std::string name() const
+    {
+        std::string res;
+        res += char('a' + sq_y(from));
+        res += char('8' - sq_x(from));
+        res += captured ? ':' : '-';
+        res += char('a' + sq_y(to));
+        res += char('8' - sq_x(to));
+        return res;
+    }
+
+    bool operator==(const bit_move& other) const
+    {
+        return from == other.from && to == other.to && captured == other.captured && promote == other.promote;
+    }
+
+    bool operator!=(const bit_move& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Перевод шага с координатами (ход игрока или шаг серии взятий) в ход движка
+inline bit_move to_bit_move(const move_pos& turn)
+{
+    const BB_T captured = turn.xb == -1 ? 0 : BB_T(1) << sq_index(turn.xb, turn.yb);
+    return bit_move(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2), captured);
+}
+
+// Слагаемые оценки позиции, которые do_move/undo_move поддерживают по ходу игры,
+// чтобы оценка листа не пересчитывала доску. Индекс - цвет (0 - белые, 1 - черные).
+struct eval_terms
+{
+    uint8_t pawns[2] = {};   // Число пешек
+    uint8_t queens[2] = {};  // Число дамок
+    int16_t advance[2] = {}; // Сумма продвижения пешек: для белых 7 - строка, для черных номер строки
+
+    // Продвижение пешки цвета color в клетке sq
+    static int pawn_advance(const bool color, const int sq)
+    {
+        return color ? sq_x(sq) : 7 - sq_x(sq);
+    }
+
+    void add(const bool color, const bool king, const int sq)
+    {
+        if (king)
+            ++queens[color];
+        else
+        {
+            ++pawns[color];
+            advance[color] += pawn_advance(color, sq);
+        }
+    }
+
+    void remove(const bool color, const bool king, const int sq)
+    {
+        if (king)
+            --queens[color];
+        else
+        {
+            --pawns[color];
+            advance[color] -= pawn_advance(color, sq);
+        }
+    }
+};
+
+// Запись для отмены хода: сам ход, какие из побитых фигур были дамками, было ли превращение,
+// хэш и слагаемые оценки позиции до хода
+struct undo_info
+{
+    bit_move turn;
+    BB_T captured_kings;
+    bool promoted;
+    uint64_t hash;
+    eval_terms eval;
+};
+
+// Список ходов фиксированного размера, чтобы генерация не выделяла память
+struct move_list
+{
+    bit_move turns[MAX_TURNS];
+    int size = 0;
+
+    void push_back(const bit_move& turn)
+    {
+        assert(size < MAX_TURNS);
+        turns[size++] = turn;
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    void clear()
+    {
+        size = 0;
+    }
+
+    bit_move& operator[](const int i)
+    {
+        return turns[i];
+    }
+
+    const bit_move& operator[](const int i) const
+    {
+        return turns[i];
+    }
+
+    bit_move* begin()
+    {
+        return turns;
+    }
+
+    bit_move* end()
+    {
+        return turns + size;
+    }
+
+    const bit_move* begin() const
+    {
+        return turns;
+    }
+
+    const bit_move* end() const
+    {
+        return turns + size;
+    }
+};
+
+// Позиция на доске в виде трех битовых масок.
+// Тривиально копируется, поэтому используется в переборе вместо матрицы 8x8.
+struct bit_position
+{
+    BB_T white = 0; // Белые фигуры
+    BB_T black = 0; // Черные фигуры
+    BB_T kings = 0; // Дамки обоих цветов
+    uint64_t hash = 0; // Ключ Зобриста, обновляется в do_move/undo_move
+    eval_terms eval; // Материал и продвижение пешек, обновляются в do_move/undo_move
+
+    // Фигуры цвета color (false - белые, true - черные)
+    BB_T pieces(const bool color) const
+    {
+        return color ? black : white;
+    }
+
+    BB_T empty() const
+    {
+        return ~(white | black);
+    }
+
+    // Код фигуры в клетке в формате Board::mtx (0 - пусто, 1/2 - пешки, 3/4 - дамки)
+    POS_T at(const int sq) const
+    {
+        const BB_T b = BB_T(1) << sq;
+        if (!((white | black) & b))
+            return 0;
+        return POS_T(((black & b) ? 2 : 1) + ((kings & b) ? 2 : 0));
+    }
+
+    // Начальная расстановка: черные на строках 0-2, белые на строках 5-7
+    static bit_position start_position()
+    {
+        std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (i < 3 && (i + j) % 2 == 1)
+                    mtx[i][j] = 2;
+                if (i > 4 && (i + j) % 2 == 1)
+                    mtx[i][j] = 1;
+            }
+        }
+        return from_mtx(mtx);
+    }
+
+    // Построение позиции по маскам фигур (хэш и слагаемые оценки считаются заново)
+    static bit_position from_masks(const BB_T white, const BB_T black, const BB_T kings)
+    {
+        bit_position pos;
+        pos.white = white;
+        pos.black = black;
+        pos.kings = kings & (white | black);
+        for (BB_T b = white | black; b;)
+        {
+            const int sq = bb_pop(b);
+            const POS_T code = pos.at(sq);
+            pos.hash ^= ZOBRIST.piece[code - 1][sq];
+            pos.eval.add(code % 2 == 0, code > 2, sq);
+        }
+        return pos;
+    }
+
+    // Построение позиции по матрице доски Board::mtx
+    static bit_position from_mtx(const std::vector<std::vector<POS_T>>& mtx)
+    {
+        bit_position pos;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                const int sq = sq_index(i, j);
+                if (sq == -1 || !mtx[i][j])
+                    continue;
+                const BB_T b = BB_T(1) << sq;
+                if (mtx[i][j] % 2)
+                    pos.white |= b;
+                else
+                    pos.black |= b;
+                if (mtx[i][j] > 2)
+                    pos.kings |= b;
+                pos.hash ^= ZOBRIST.piece[mtx[i][j] - 1][sq];
+                pos.eval.add(mtx[i][j] % 2 == 0, mtx[i][j] > 2, sq);
+            }
+        }
+        return pos;
+    }
+
+    // Обратное преобразование в матрицу доски
+    std::vector<std::vector<POS_T>> to_mtx() const
+    {
+        std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+        for (int sq = 0; sq < 32; ++sq)
+            mtx[sq_x(sq)][sq_y(sq)] = at(sq);
+        return mtx;
+    }
+
+    // Позиция строкой из 32 символов по клеткам в порядке номеров (строка 0 - сторона черных):
+    // '.' - пусто, 'w'/'b' - белая/черная шашка, 'W'/'B' - белая/черная дамка
+    std::string to_string() const
+    {
+        std::string res;
+        for (int sq = 0; sq < 32; ++sq)
+            res += PIECE_CHARS[at(sq)];
+        return res;
+    }
+
+    /**
+     * Разбирает позицию из строки формата to_string.
+     * @param str Строка из 32 символов.
+     * @param pos Позиция, в которую записывается результат.
+     * @return false, если строка некорректна.
+     */
+    static bool from_string(const std::string& str, bit_position& pos)
+    {
+        if (str.size() != 32)
+            return false;
+        std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+        for (int sq = 0; sq < 32; ++sq)
+        {
+            const size_t code = std::string(PIECE_CHARS).find(str[sq]);
+            if (code == std::string::npos)
+                return false;
+            mtx[sq_x(sq)][sq_y(sq)] = POS_T(code);
+        }
+        pos = from_mtx(mtx);
+        return true;
+    }
+
+    /**
+     * Выполняет ход на месте и запоминает всё, что нужно для его отмены.
+     * @param turn Ход, который нужно выполнить.
+     * @return Запись для undo_move.
+     */
+    undo_info do_move(const bit_move& turn)
+    {
+        undo_info undo{ turn, turn.captured & kings, false, hash, eval };
+        const BB_T from = BB_T(1) << turn.from, to = BB_T(1) << turn.to;
+        for (BB_T b = turn.captured; b;)
+        {
+            const int sq = bb_pop(b);
+            const POS_T code = at(sq);
+            hash ^= ZOBRIST.piece[code - 1][sq];
+            eval.remove(code % 2 == 0, code > 2, sq);
+        }
+        const POS_T code = at(turn.from);
+        hash ^= ZOBRIST.piece[code - 1][turn.from];
+        eval.remove(code % 2 == 0, code > 2, turn.from);
+        white &= ~turn.captured; // Удаляем побитые фигуры
+        black &= ~turn.captured;
+        kings &= ~turn.captured;
+        if (white & from)
+        {
+            white ^= from ^ to;
+            undo.promoted = (turn.promote || (to & BB_ROW_0)) && !(kings & from);
+        }
+        else
+        {
+            black ^= from ^ to;
+            undo.promoted = (turn.promote || (to & BB_ROW_7)) && !(kings & from);
+        }
+        if (kings & from)
+            kings ^= from ^ to;
+        if (undo.promoted)
+            kings |= to; // Превращаем пешку в дамку
+        hash ^= ZOBRIST.piece[at(turn.to) - 1][turn.to];
+        eval.add(code % 2 == 0, code > 2 || undo.promoted, turn.to);
+        return undo;
+    }
+
+    /**
+     * Отменяет ход, выполненный do_move.
+     * @param undo Запись, которую вернул do_move.
+     */
+    void undo_move(const undo_info& undo)
+    {
+        const BB_T from = BB_T(1) << undo.turn.from, to = BB_T(1) << undo.turn.to;
+        if (kings & to)
+        {
+            kings &= ~to;
+            if (!undo.promoted)
+                kings |= from;
+        }
+        if (white & to)
+        {
+            white ^= from ^ to;
+            black |= undo.turn.captured; // Возвращаем побитые фигуры
+        }
+        else
+        {
+            black ^= from ^ to;
+            white |= undo.turn.captured;
+        }
+        kings |= undo.captured_kings;
+        hash = undo.hash;
+        eval = undo.eval;
+    }
+
+    /**
+     * Находит все ходы цвета color для движка. Если есть взятия, возвращаются только они,
+     * причем каждая серия взятий целиком - один ход.
+     * Цвет - параметр шаблона, чтобы перебор получал отдельный код для каждой стороны без ветвлений.
+     * @tparam color Цвет игрока.
+     * @param list Список, в который записываются ходы.
+     * @return Есть ли взятия.
+     */
+    template <bool color>
+    bool gen_turns(move_list& list) const
+    {
+        list.clear();
+        move_list jumps;
+        gen_beats<color>(pieces(color), jumps);
+        for (const auto& jump : jumps)
+        {
+            bit_position next = *this;
+            next.do_move(jump);
+            next.gen_series<color>(jump.from, jump.to, jump.captured, !(kings & (BB_T(1) << jump.from)), list);
+        }
+        if (!list.empty())
+            return true;
+        gen_quiet<color>(pieces(color), list);
+        return false;
+    }
+
+    // То же для цвета, известного только во время выполнения
+    bool gen_turns(const bool color, move_list& list) const
+    {
+        return color ? gen_turns<true>(list) : gen_turns<false>(list);
+    }
+
+    /**
+     * Находит ходы цвета color по одному шагу (одно взятие за раз), как их делает игрок.
+     * @param color Цвет игрока.
+     * @param list Список, в который записываются ходы.
+     * @return Есть ли взятия.
+     */
+    bool gen_steps(const bool color, move_list& list) const
+    {
+        list.clear();
+        gen_beats(color, pieces(color), list);
+        if (!list.empty())
+            return true;
+        gen_quiet(color, pieces(color), list);
+        return false;
+    }
+
+    /**
+     * Находит шаги одной фигуры: взятия, а если их нет - обычные ходы.
+     * @param sq Номер клетки с фигурой.
+     * @param list Список, в который записываются ходы.
+     * @return Есть ли взятия.
+     */
+    bool gen_steps_from(const int sq, move_list& list) const
+    {
+        list.clear();
+        const BB_T b = BB_T(1) << sq;
+        const bool color = (black & b) != 0;
+        gen_beats(color, b, list);
+        if (!list.empty())
+            return true;
+        gen_quiet(color, b, list);
+        return false;
+    }
+
+    /**
+     * Раскладывает ход движка на шаги для Board: серия взятий - по одному взятию на шаг.
+     * @param turn Ход, найденный gen_turns в этой позиции.
+     * @return Последовательность шагов.
+     */
+    std::vector<move_pos> expand(const bit_move& turn) const
+    {
+        std::vector<move_pos> path;
+        if (!turn.captured)
+            path.push_back(turn.to_move_pos());
+        else
+            expand_series(turn, turn.from, turn.captured, path);
+        return path;
+    }
+
+    bool operator==(const bit_position& other) const
+    {
+        return white == other.white && black == other.black && kings == other.kings;
+    }
+
+    bool operator!=(const bit_position& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    static constexpr const char* PIECE_CHARS = ".wbWB"; // Символы фигур по их кодам в матрице доски
+
+    // Продолжает серию взятий фигурой цвета color, стоящей в клетке sq после уже сделанных взятий.
+    // Серия заканчивается, только когда бить больше нечего.
+    template <bool color>
+    void gen_series(const int origin, const int sq, const BB_T captured, const bool was_pawn, move_list& list) const
+    {
+        const BB_T b = BB_T(1) << sq;
+        move_list jumps;
+        gen_beats<color>(b, jumps);
+        if (jumps.empty())
+        {
+            const bit_move turn(origin, sq, captured, was_pawn && (kings & b));
+            for (const auto& other : list)
+            {
+                if (other == turn)
+                    return; // Та же серия, найденная другим путем
+            }
+            list.push_back(turn);
+            return;
+        }
+        for (const auto& jump : jumps)
+        {
+            bit_position next = *this;
+            next.do_move(jump);
+            next.gen_series<color>(origin, jump.to, captured | jump.captured, was_pawn, list);
+        }
+    }
+
+    // Восстанавливает шаги серии взятий по маске побитых фигур
+    bool expand_series(const bit_move& turn, const int sq, const BB_T left, std::vector<move_pos>& path) const
+    {
+        if (!left)
+            return sq == turn.to;
+        const BB_T b = BB_T(1) << sq;
+        move_list jumps;
+        gen_beats((black & b) != 0, b, jumps);
+        for (const auto& jump : jumps)
+        {
+            if (!(jump.captured & left))
+                continue;
+            bit_position next = *this;
+            next.do_move(jump);
+            path.push_back(jump.to_move_pos());
+            if (next.expand_series(turn, jump.to, left & ~jump.captured, path))
+                return true;
+            path.pop_back();
+        }
+        return false;
+    }
+
+    void gen_beats(const bool color, const BB_T from_mask, move_list& list) const
+    {
+        color ? gen_beats<true>(from_mask, list) : gen_beats<false>(from_mask, list);
+    }
+
+    void gen_quiet(const bool color, const BB_T from_mask, move_list& list) const
+    {
+        color ? gen_quiet<true>(from_mask, list) : gen_quiet<false>(from_mask, list);
+    }
+
+    // Взятия фигурами цвета color из маски from_mask
+    template <bool color>
+    void gen_beats(const BB_T from_mask, move_list& list) const
+    {
+        const BB_T opp = pieces(!color), free = empty();
+        const BB_T pawns = from_mask & ~kings;
+        for (int d = 0; d < 4; ++d)
+        {
+            // Пешка бьет в любую сторону: соседняя клетка - соперник, следующая - пустая
+            BB_T jumpers = pawns & bb_step(opp & bb_step(free, 3 - d), 3 - d);
+            while (jumpers)
+            {
+                const int s = bb_pop(jumpers);
+                const BB_T mid = bb_step(BB_T(1) << s, d);
+                list.push_back(bit_move(s, bb_lsb(bb_step(mid, d)), mid));
+            }
+        }
+        BB_T queens = from_mask & kings;
+        while (queens)
+        {
+            const int s = bb_pop(queens);
+            for (int d = 0; d < 4; ++d)
+            {
+                BB_T b = bb_step(BB_T(1) << s, d);
+                while (b & free)
+                    b = bb_step(b, d);
+                if (!(b & opp))
+                    continue;
+                for (BB_T land = bb_step(b, d); land & free; land = bb_step(land, d))
+                    list.push_back(bit_move(s, bb_lsb(land), b));
+            }
+        }
+    }
+
+    // Обычные ходы фигурами цвета color из маски from_mask
+    template <bool color>
+    void gen_quiet(const BB_T from_mask, move_list& list) const
+    {
+        const BB_T free = empty();
+        const BB_T pawns = from_mask & ~kings;
+        const int first_dir = color ? DIR_DL : DIR_UL; // Пешки ходят только вперед
+        for (int d = first_dir; d < first_dir + 2; ++d)
+        {
+            BB_T dest = bb_step(pawns, d) & free;
+            while (dest)
+            {
+                const int t = bb_pop(dest);
+                list.push_back(bit_move(bb_lsb(bb_step(BB_T(1) << t, 3 - d)), t));
+            }
+        }
+        BB_T queens = from_mask & kings;
+        while (queens)
+        {
+            const int s = bb_pop(queens);
+            for (int d = 0; d < 4; ++d)
+            {
+                for (BB_T b = bb_step(BB_T(1) << s, d); b & free; b = bb_step(b, d))
+                    list.push_back(bit_move(s, bb_lsb(b)));
+            }
+        }
+    }
+};
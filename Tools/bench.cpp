@@ -0,0 +1,368 @@
+// Микробенчмарки горячих мест движка: генерация ходов, выполнение хода, оценка позиции
+// и поиск фиксированной глубины на сохраненных позициях.
+// Каждый замер повторяется несколько раз, выводится медиана, поэтому результаты можно сравнивать между запусками.
+//
+// Использование: bench [--filter=<подстрока>] [--min_time=<сек>] [--repetitions=<N>] [--json=<файл>]
+//
+// Настройки бота берутся из settings.json, но то, что влияет на скорость и детерминированность
+// (NoRandom, BotThreads, BotTimeMS, Optimization, HashSizeMB, QuiescenceNodes), фиксируется.
+// Поиск фиксированной глубины замеряется для профилей O1 и O2, чтобы сравнить время до глубины
+// (например, --filter=start/ выводит оба профиля на начальной позиции).
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+
+// Сохраненные позиции в формате bit_position::to_string
+struct bench_position
+{
+    const char* name;
+    const char* position;
+    bool color;
+    int depth; // Max_depth для поиска фиксированной глубины (поиск идет до глубины depth + 1)
+};
+
+const bench_position BENCH_POSITIONS[] = {
+    { "start", "bbbbbbbbbbbb........wwwwwwwwwwww", false, 9 },
+    { "mid_quiet", ".bbb...b.b.b.b.b....wwww..www..w", false, 9 },
+    { "mid_tactics", ".bbbb...b.bb.b.b..bwwbw.wwwww.w.", false, 9 },
+    { "mid_open", "..bb..b...b..w.bw...w..w...ww..w", false, 9 },
+    { "end_pawns", "....b..bb.b..b....w.ww.....ww...", false, 11 },
+    { "end_king", ".bb..b..b..........ww.......w.wB", false, 9 },
+    { "end_kings", "....B.......w.b.........W..w....", true, 7 },
+};
+
+// Результат, который нельзя выбросить при оптимизации
+volatile uint64_t bench_sink = 0;
+
+// Состояние одного замера: считает итерации и время, позволяет исключить подготовку из замера
+class bench_state
+{
+public:
+    explicit bench_state(const uint64_t iterations) : iterations(iterations)
+    {
+    }
+
+    bool keep_running()
+    {
+        if (done == 0)
+            start = std::chrono::steady_clock::now();
+        if (done == iterations)
+        {
+            if (!paused)
+                total += std::chrono::steady_clock::now() - start;
+            return false;
+        }
+        ++done;
+        return true;
+    }
+
+    void pause_timing()
+    {
+        total += std::chrono::steady_clock::now() - start;
+        paused = true;
+    }
+
+    void resume_timing()
+    {
+        paused = false;
+        start = std::chrono::steady_clock::now();
+    }
+
+    // Сколько операций делает одна итерация (например, по ходу на каждую позицию)
+    void set_items(const uint64_t count)
+    {
+        items = count;
+    }
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(total).count();
+    }
+
+    uint64_t operations() const
+    {
+        return iterations * std::max<uint64_t>(items, 1);
+    }
+
+private:
+    uint64_t iterations;
+    uint64_t done = 0;
+    uint64_t items = 0;
+    bool paused = false;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration total{ 0 };
+};
+
+struct bench_result
+{
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;  // Медиана по повторам
+    double min_ns;     // Лучший повтор
+};
+
+struct benchmark
+{
+    std::string name;
+    std::function<void(bench_state&)> run;
+};
+
+// Подбирает число итераций так, чтобы замер шел не меньше min_time секунд, и повторяет его
+bench_result measure(const benchmark& bench, const double min_time, const int repetitions)
+{
+    uint64_t iterations = 1;
+    while (true)
+    {
+        bench_state state(iterations);
+        bench.run(state);
+        if (state.seconds() >= min_time || iterations >= (uint64_t(1) << 40))
+            break;
+        const double scale = state.seconds() > 0 ? min_time * 1.4 / state.seconds() : 10;
+        iterations = std::max(iterations + 1, uint64_t(iterations * std::min(scale, 10.0)));
+    }
+    std::vector<double> times;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        bench_state state(iterations);
+        bench.run(state);
+        times.push_back(state.seconds() * 1e9 / state.operations());
+    }
+    std::sort(times.begin(), times.end());
+    return { bench.name, iterations, times[times.size() / 2], times.front() };
+}
+
+std::vector<benchmark> make_benchmarks(Config& config)
+{
+    std::vector<bit_position> positions;
+    std::vector<bool> colors;
+    for (const auto& p : BENCH_POSITIONS)
+    {
+        bit_position pos;
+        bit_position::from_string(p.position, pos);
+        positions.push_back(pos);
+        colors.push_back(p.color);
+    }
+
+    std::vector<benchmark> res;
+    res.push_back({ "find_turns/color/mtx", [&config, positions, colors](bench_state& state) {
+        Logic logic(&config);
+        std::vector<std::vector<std::vector<POS_T>>> mtxs;
+        for (const auto& pos : positions)
+            mtxs.push_back(pos.to_mtx());
+        state.set_items(mtxs.size());
+        while (state.keep_running())
+        {
+            for (size_t i = 0; i < mtxs.size(); ++i)
+            {
+                logic.find_turns(colors[i], mtxs[i]);
+                bench_sink += logic.turns.size();
+            }
+        }
+    } });
+    res.push_back({ "find_turns/color/position", [&config, positions, colors](bench_state& state) {
+        Logic logic(&config);
+        state.set_items(positions.size());
+        while (state.keep_running())
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                logic.find_turns(colors[i], positions[i]);
+                bench_sink += logic.turns.size();
+            }
+        }
+    } });
+    res.push_back({ "find_turns/piece/mtx", [&config, positions, colors](bench_state& state) {
+        Logic logic(&config);
+        std::vector<std::vector<std::vector<POS_T>>> mtxs;
+        std::vector<std::vector<int>> squares(positions.size());
+        uint64_t count = 0;
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            mtxs.push_back(positions[i].to_mtx());
+            for (BB_T b = positions[i].pieces(colors[i]); b;)
+                squares[i].push_back(bb_pop(b));
+            count += squares[i].size();
+        }
+        state.set_items(count);
+        while (state.keep_running())
+        {
+            for (size_t i = 0; i < mtxs.size(); ++i)
+            {
+                for (const int sq : squares[i])
+                {
+                    logic.find_turns(sq_x(sq), sq_y(sq), mtxs[i]);
+                    bench_sink += logic.turns.size();
+                }
+            }
+        }
+    } });
+    res.push_back({ "find_turns/piece/position", [&config, positions, colors](bench_state& state) {
+        Logic logic(&config);
+        std::vector<std::vector<int>> squares(positions.size());
+        uint64_t count = 0;
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            for (BB_T b = positions[i].pieces(colors[i]); b;)
+                squares[i].push_back(bb_pop(b));
+            count += squares[i].size();
+        }
+        state.set_items(count);
+        while (state.keep_running())
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                for (const int sq : squares[i])
+                {
+                    logic.find_turns(sq_x(sq), sq_y(sq), positions[i]);
+                    bench_sink += logic.turns.size();
+                }
+            }
+        }
+    } });
+    res.push_back({ "gen_turns", [positions, colors](bench_state& state) {
+        state.set_items(positions.size());
+        move_list list;
+        while (state.keep_running())
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                positions[i].gen_turns(colors[i], list);
+                bench_sink += list.size;
+            }
+        }
+    } });
+    res.push_back({ "make_turn", [&config, positions, colors](bench_state& state) {
+        Logic logic(&config);
+        std::vector<std::pair<size_t, bit_move>> turns;
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            move_list list;
+            positions[i].gen_turns(colors[i], list);
+            for (const auto& turn : list)
+                turns.emplace_back(i, turn);
+        }
+        state.set_items(turns.size());
+        while (state.keep_running())
+        {
+            for (const auto& turn : turns)
+                bench_sink += logic.make_turn(positions[turn.first], turn.second).hash;
+        }
+    } });
+    for (const std::string mode : { "NumberOnly", "NumberAndPotential" })
+    {
+        res.push_back({ "calc_score/" + mode, [&config, positions, mode](bench_state& state) {
+            config.set("Bot", "BotScoringType", mode);
+            Logic logic(&config);
+            state.set_items(positions.size() * 2);
+            while (state.keep_running())
+            {
+                for (const auto& pos : positions)
+                {
+                    bench_sink += uint64_t(logic.calc_score(pos, true) * 1000);
+                    bench_sink += uint64_t(logic.calc_score(pos, false) * 1000);
+                }
+            }
+        } });
+    }
+    for (const std::string optimization : { "O1", "O2" })
+    {
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            const bench_position& p = BENCH_POSITIONS[i];
+            const bit_position pos = positions[i];
+            res.push_back({ "find_best_turns/" + optimization + "/" + p.name + "/depth:" + std::to_string(p.depth + 1),
+                            [&config, pos, p, optimization](bench_state& state) {
+                config.set("Bot", "BotScoringType", "NumberAndPotential");
+                config.set("Bot", "Optimization", optimization);
+                while (state.keep_running())
+                {
+                    // Каждый поиск начинается с пустой таблицы транспозиций и истории
+                    state.pause_timing();
+                    auto logic = std::make_unique<Logic>(&config);
+                    logic->Max_depth = p.depth;
+                    state.resume_timing();
+                    bench_sink += logic->find_best_turns(p.color, pos).size();
+                    state.pause_timing();
+                    logic.reset();
+                    state.resume_timing();
+                }
+            } });
+        }
+    }
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter, json_path;
+    double min_time = 0.2;
+    int repetitions = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0)
+            filter = arg.substr(9);
+        else if (arg.rfind("--min_time=", 0) == 0)
+            min_time = std::stod(arg.substr(11));
+        else if (arg.rfind("--repetitions=", 0) == 0)
+            repetitions = std::max(1, std::stoi(arg.substr(14)));
+        else if (arg.rfind("--json=", 0) == 0)
+            json_path = arg.substr(7);
+        else
+        {
+            std::cerr << "Usage: bench [--filter=<substring>] [--min_time=<sec>] [--repetitions=<N>] [--json=<file>]\n";
+            return 1;
+        }
+    }
+
+    // Фиксируем настройки, от которых зависит время: один поток, без случайности и ограничения времени,
+    // без дебютной книги и базы эндшпиля (иначе поиск подменяется чтением из них) и без фонового поиска
+    Config config;
+    config.set("Bot", "OpeningBookPath", "");
+    config.set("Bot", "TablebasePath", "");
+    config.set("Bot", "Pondering", false);
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "BotThreads", 1);
+    config.set("Bot", "BotTimeMS", 0);
+    config.set("Bot", "Optimization", "O1");
+    config.set("Bot", "HashSizeMB", 16);
+    config.set("Bot", "QuiescenceNodes", 1000);
+    config.set("Bot", "BotScoringType", "NumberAndPotential");
+
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(16) << "Time (ns)"
+              << std::setw(16) << "Best (ns)" << std::setw(14) << "Iterations" << '\n';
+    std::cout << std::string(90, '-') << '\n';
+    std::vector<bench_result> results;
+    for (const auto& bench : make_benchmarks(config))
+    {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos)
+            continue;
+        results.push_back(measure(bench, min_time, repetitions));
+        const auto& r = results.back();
+        std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << r.ns_per_op << std::setw(16) << r.min_ns << std::setw(14) << r.iterations << '\n';
+    }
+
+    if (!json_path.empty())
+    {
+        json out;
+        out["repetitions"] = repetitions;
+        out["min_time"] = min_time;
+        out["benchmarks"] = json::array();
+        for (const auto& r : results)
+            out["benchmarks"].push_back({ { "name", r.name }, { "iterations", r.iterations },
+                                          { "ns_per_op", r.ns_per_op }, { "min_ns", r.min_ns } });
+        std::ofstream(json_path) << out.dump(2) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Построение дебютной книги для OpeningBookPath.
+// Использование:
+//   bookgen search <plies> <output> [settings.json]
+//     перебирает все позиции первых plies полуходов и записывает лучший ход поиска в каждой из них;
+//     глубина поиска - WhiteBotLevel или BlackBotLevel в зависимости от цвета.
+//   bookgen selfplay <games> <plies> <output> [settings.json]
+//     играет партии бота против самого себя со случайным выбором среди равных ходов и записывает
+//     первые plies полуходов: ходы победителя получают вес 2, ходы обеих сторон в ничьей - вес 1.
+//     Партии судятся по тем же правилам ничьей, что и в Game (MaxNumTurns, DrawRepetitions, DrawQuietTurns).
+//
+// Во время построения книга не используется (OpeningBookPath пустой), чтобы не повторять старую книгу.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Game/OpeningBook.h"
+#include "../Game/PositionHistory.h"
+
+int bot_level(Config& config, const bool color)
+{
+    return config("Bot", std::string(color ? "Black" : "White") + "BotLevel");
+}
+
+// Лучший ход бота целиком (серия взятий - одним ходом)
+bit_move best_turn(Logic& logic, const bool color, const bit_position& pos)
+{
+    logic.find_best_turns(color, pos);
+    return logic.last_stats().pv.front();
+}
+
+// Все позиции до plies полуходов: в каждой записывается ход поиска, продолжаются все ходы
+void build_search(Config& config, const int plies, OpeningBookBuilder& builder)
+{
+    config.set("Bot", "NoRandom", true);
+    Logic logic(&config);
+    std::vector<bit_position> level = { bit_position::start_position() };
+    std::unordered_set<uint64_t> seen;
+    for (int ply = 0; ply < plies; ++ply)
+    {
+        const bool color = ply % 2;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<bit_position> next;
+        for (const auto& pos : level)
+        {
+            if (!seen.insert(OpeningBook::position_key(pos, color)).second)
+                continue;
+            move_list list;
+            pos.gen_turns(color, list);
+            if (list.empty())
+                continue;
+            logic.Max_depth = bot_level(config, color);
+            builder.add(OpeningBook::position_key(pos, color), best_turn(logic, color, pos));
+            for (const auto& turn : list)
+            {
+                next.push_back(pos);
+                next.back().do_move(turn);
+            }
+        }
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "ply " << ply + 1 << ": " << level.size() << " positions, " << sec << " s" << std::endl;
+        level.swap(next);
+    }
+}
+
+// Партии бота против самого себя: в книгу идут ходы стороны, которая не проиграла
+void build_selfplay(Config& config, const int games, const int plies, OpeningBookBuilder& builder)
+{
+    config.set("Bot", "NoRandom", false);
+    const int max_turns = config("Game", "MaxNumTurns");
+    const DrawRules draw_rules(config);
+    int results[3] = {}; // победы белых, победы черных, ничьи
+    for (int game = 0; game < games; ++game)
+    {
+        Logic logic(&config);
+        bit_position pos = bit_position::start_position();
+        std::vector<std::pair<uint64_t, bit_move>> opening;
+        PositionHistory history;
+        int turn_num = -1;
+        bool is_draw = false;
+        while (++turn_num < max_turns)
+        {
+            const bool color = turn_num % 2;
+            move_list list;
+            pos.gen_turns(color, list);
+            if (list.empty())
+                break;
+            const uint64_t key = OpeningBook::position_key(pos, color);
+            if (draw_rules.is_draw(history, key))
+            {
+                is_draw = true;
+                break;
+            }
+            logic.set_position_history(history.reversible_keys());
+            logic.Max_depth = bot_level(config, color);
+            const bit_move turn = best_turn(logic, color, pos);
+            if (turn_num < plies)
+                opening.emplace_back(key, turn);
+            history.push(key, PositionHistory::is_progress(pos, turn));
+            pos.do_move(turn);
+        }
+
+        // Ходящий без ходов проиграл; партия, дошедшая до MaxNumTurns или до правила ничьей, - ничья
+        const bool draw = is_draw || turn_num >= max_turns;
+        const bool winner = turn_num % 2 == 0;
+        ++results[draw ? 2 : winner];
+        for (size_t i = 0; i < opening.size(); ++i)
+        {
+            if (draw)
+                builder.add(opening[i].first, opening[i].second, 1);
+            else if (bool(i % 2) == winner)
+                builder.add(opening[i].first, opening[i].second, 2);
+        }
+        std::cout << "game " << game + 1 << '/' << games << ": "
+                  << (draw ? "draw" : (winner ? "black wins" : "white wins")) << " in " << turn_num << " turns"
+                  << std::endl;
+    }
+    std::cout << "White +" << results[0] << " Black +" << results[1] << " =" << results[2] << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+    const bool search = mode == "search" && argc >= 4;
+    const bool selfplay = mode == "selfplay" && argc >= 5;
+    if (!search && !selfplay)
+    {
+        std::cerr << "Usage: bookgen search <plies> <output> [settings.json]\n"
+                     "       bookgen selfplay <games> <plies> <output> [settings.json]\n";
+        return 1;
+    }
+    const int settings_arg = search ? 4 : 5;
+    Config config = argc > settings_arg ? Config(argv[settings_arg]) : Config();
+    config.set("Bot", "OpeningBookPath", "");
+
+    OpeningBookBuilder builder;
+    std::string out_path;
+    if (search)
+    {
+        out_path = argv[3];
+        build_search(config, std::stoi(argv[2]), builder);
+    }
+    else
+    {
+        out_path = argv[4];
+        build_selfplay(config, std::stoi(argv[2]), std::stoi(argv[3]), builder);
+    }
+    if (!builder.save(out_path))
+    {
+        std::cerr << "Can't write " << out_path << '\n';
+        return 1;
+    }
+    std::cout << builder.size() << " book moves written to " << out_path << '\n';
+    return 0;
+}
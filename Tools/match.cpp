@@ -0,0 +1,179 @@
+// Матч бот против бота без окна и SDL: движок Logic вызывается напрямую.
+// Играет N партий между двумя конфигурациями (файлами настроек в формате settings.json),
+// меняя цвета каждую партию, и сохраняет результаты в CSV или JSON.
+//
+// Использование: match <settings_a.json> <settings_b.json> [games] [results.csv|results.json]
+//
+// Каждая конфигурация играет так же, как бот в Game: уровень берется из WhiteBotLevel
+// или BlackBotLevel в зависимости от цвета, ограничение партии - MaxNumTurns конфигурации A.
+// Правила ничьей (DrawRepetitions, DrawQuietTurns) тоже берутся из конфигурации A;
+// DrawQuietTurns поиск и база эндшпиля не учитывают, см. Logic::probe_tablebase.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Game/PositionHistory.h"
+
+// Итог одной партии с точки зрения конфигурации A
+struct game_result
+{
+    int game = 0;
+    bool a_white = true;
+    char result = 'D';       // W - победа A, L - поражение A, D - ничья
+    int turns = 0;           // Число ходов в партии
+    int moves[2] = {};       // Ходов сделано конфигурациями A и B
+    double ms[2] = {};       // Суммарное время на ходы A и B
+    double max_ms[2] = {};   // Самый долгий ход A и B
+    uint64_t nodes[2] = {};  // Суммарное число узлов A и B
+};
+
+// Играет одну партию; engine 0 - конфигурация A, engine 1 - B
+game_result play_game(Config* configs[2], const int game, const bool a_white)
+{
+    game_result res;
+    res.game = game;
+    res.a_white = a_white;
+
+    Logic engines[2] = { Logic(configs[0]), Logic(configs[1]) };
+    bit_position pos = bit_position::start_position();
+    const int max_turns = (*configs[0])("Game", "MaxNumTurns");
+    const DrawRules draw_rules(*configs[0]);
+    PositionHistory history;
+
+    int turn_num = -1;
+    bool is_draw = false;
+    while (++turn_num < max_turns)
+    {
+        const bool color = turn_num % 2;
+        const int side = (color == !a_white) ? 0 : 1;
+        move_list list;
+        pos.gen_turns(color, list);
+        if (list.empty())
+            break;
+
+        // Ничья по повторению позиции или по числу ходов без взятий и ходов простыми
+        const uint64_t key = OpeningBook::position_key(pos, color);
+        if (draw_rules.is_draw(history, key))
+        {
+            is_draw = true;
+            break;
+        }
+
+        Logic& logic = engines[side];
+        logic.set_position_history(history.reversible_keys());
+        logic.Max_depth = (*configs[side])("Bot", std::string(color ? "Black" : "White") + "BotLevel");
+        auto start = std::chrono::steady_clock::now();
+        auto steps = logic.find_best_turns(color, pos);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        res.moves[side] += 1;
+        res.ms[side] += ms;
+        res.max_ms[side] = std::max(res.max_ms[side], ms);
+        res.nodes[side] += logic.searched_nodes();
+        history.push(key, PositionHistory::is_progress(pos, to_bit_move(steps.front())));
+        for (const auto& step : steps)
+            pos.do_move(to_bit_move(step));
+    }
+
+    res.turns = turn_num;
+    if (turn_num < max_turns && !is_draw)
+    {
+        // Проигрывает тот, кому нечем ходить
+        const bool loser_white = turn_num % 2 == 0;
+        res.result = (loser_white == a_white) ? 'L' : 'W';
+    }
+    return res;
+}
+
+void write_csv(std::ostream& out, const std::vector<game_result>& results)
+{
+    out << "game,a_color,result,turns,a_moves,b_moves,a_ms_per_move,b_ms_per_move,a_max_ms,b_max_ms,"
+           "a_nodes_per_move,b_nodes_per_move\n";
+    for (const auto& r : results)
+    {
+        out << r.game << ',' << (r.a_white ? "white" : "black") << ',' << r.result << ',' << r.turns;
+        for (int i = 0; i < 2; ++i)
+            out << ',' << r.moves[i];
+        for (int i = 0; i < 2; ++i)
+            out << ',' << (r.moves[i] ? r.ms[i] / r.moves[i] : 0);
+        for (int i = 0; i < 2; ++i)
+            out << ',' << r.max_ms[i];
+        for (int i = 0; i < 2; ++i)
+            out << ',' << (r.moves[i] ? r.nodes[i] / r.moves[i] : 0);
+        out << '\n';
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<game_result>& results)
+{
+    json arr = json::array();
+    for (const auto& r : results)
+    {
+        json item;
+        item["game"] = r.game;
+        item["a_color"] = r.a_white ? "white" : "black";
+        item["result"] = std::string(1, r.result);
+        item["turns"] = r.turns;
+        const char* names[2] = { "a", "b" };
+        for (int i = 0; i < 2; ++i)
+        {
+            item[std::string(names[i]) + "_moves"] = r.moves[i];
+            item[std::string(names[i]) + "_ms_per_move"] = r.moves[i] ? r.ms[i] / r.moves[i] : 0;
+            item[std::string(names[i]) + "_max_ms"] = r.max_ms[i];
+            item[std::string(names[i]) + "_nodes_per_move"] = r.moves[i] ? r.nodes[i] / r.moves[i] : 0;
+        }
+        arr.push_back(item);
+    }
+    out << arr.dump(2) << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: match <settings_a.json> <settings_b.json> [games] [results.csv|results.json]\n";
+        return 1;
+    }
+    Config config_a(argv[1]), config_b(argv[2]);
+    Config* configs[2] = { &config_a, &config_b };
+    const int games = argc > 3 ? std::stoi(argv[3]) : 2;
+    const std::string out_path = argc > 4 ? argv[4] : "match_results.csv";
+
+    std::vector<game_result> results;
+    int wins = 0, draws = 0, losses = 0;
+    double ms[2] = {};
+    int moves[2] = {};
+    for (int game = 0; game < games; ++game)
+    {
+        results.push_back(play_game(configs, game, game % 2 == 0));
+        const auto& r = results.back();
+        wins += r.result == 'W';
+        draws += r.result == 'D';
+        losses += r.result == 'L';
+        for (int i = 0; i < 2; ++i)
+        {
+            ms[i] += r.ms[i];
+            moves[i] += r.moves[i];
+        }
+        std::cout << "game " << game + 1 << '/' << games << ": " << r.result << " in " << r.turns << " turns\n";
+    }
+
+    std::ofstream fout(out_path);
+    if (out_path.size() >= 5 && out_path.substr(out_path.size() - 5) == ".json")
+        write_json(fout, results);
+    else
+        write_csv(fout, results);
+    fout.close();
+
+    std::cout << "A vs B: +" << wins << " =" << draws << " -" << losses
+              << " (score " << (games ? 100.0 * (wins + 0.5 * draws) / games : 0) << "%)\n";
+    std::cout << "A: " << (moves[0] ? ms[0] / moves[0] : 0) << " ms/move, B: " << (moves[1] ? ms[1] / moves[1] : 0)
+              << " ms/move\n";
+    std::cout << "Results written to " << out_path << '\n';
+    return 0;
+}
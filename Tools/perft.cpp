@@ -0,0 +1,230 @@
+// Perft: подсчет числа позиций на глубине N для проверки и замера скорости генератора ходов.
+// Серия взятий считается одним ходом, как в движке (bit_position::gen_turns).
+//
+// Использование:
+//   perft <depth> [position] [w|b] [--divide] [--steps]
+//   perft --check [max_depth]
+//
+// position - 32 символа по клеткам в порядке номеров (строка 0 - сторона черных):
+// '.' - пусто, 'w'/'b' - белая/черная шашка, 'W'/'B' - белая/черная дамка. По умолчанию - начальная позиция.
+// --divide выводит число позиций после каждого хода из корня.
+// --steps считает те же ходы через Logic::find_turns по одному взятию, как их делает игрок,
+// и должен давать тот же результат, что и генератор движка.
+// --check сверяет результат с эталонными значениями (до глубины max_depth, по умолчанию 8)
+// и проверяет, что --steps дает те же числа.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Game/Logic.h"
+
+// Эталонные значения perft для русских шашек по правилам игры (пешки бьют назад, дамки дальнобойные,
+// побитые фигуры снимаются сразу): глубины 1, 2, ... Все значения, включая start до глубины 12,
+// пересчитаны отдельным perft на исходном генераторе ходов по матрице доски (Logic::find_turns и make_turn
+// до перехода на битовые доски), а не этим генератором: серия взятий - один ход, серии с одними и теми же
+// начальной, конечной клеткой и побитыми фигурами считаются одним ходом, как в bit_move.
+struct perft_case
+{
+    const char* name;
+    const char* position;
+    bool color;
+    std::vector<uint64_t> counts;
+};
+
+const perft_case PERFT_CASES[] = {
+    { "start", "bbbbbbbbbbbb........wwwwwwwwwwww", false,
+      { 7, 49, 302, 1469, 7482, 37986, 190146, 929978, 4571311, 22480790, 111223865, 547272925 } },
+    { "opening", "bbbbbbbb.bbb.b......wwwww.wwwwww", false, { 9, 56, 302, 1538, 7831, 40102, 202667 } },
+    { "kings", "....B.......w.b.........W..w....", true, { 9, 40, 290, 2235, 14357, 109990, 708246 } },
+};
+
+// Число позиций на глубине depth по ходам движка
+uint64_t perft(bit_position& pos, const bool color, const int depth)
+{
+    move_list list;
+    pos.gen_turns(color, list);
+    if (depth == 1)
+        return list.size;
+    uint64_t count = 0;
+    for (const auto& turn : list)
+    {
+        const undo_info undo = pos.do_move(turn);
+        count += perft(pos, !color, depth - 1);
+        pos.undo_move(undo);
+    }
+    return count;
+}
+
+// Собирает ходы через Logic::find_turns: после взятия серия продолжается той же фигурой,
+// пока ей есть кого бить (как в Game::player_turn и Game::bot_turn)
+void collect_steps(Logic& logic, const bit_position& pos, const bit_move& turn, const bool was_pawn,
+                   std::vector<bit_move>& res)
+{
+    logic.find_turns(sq_x(turn.to), sq_y(turn.to), pos);
+    if (!logic.have_beats)
+    {
+        bit_move full = turn;
+        full.promote = was_pawn && (pos.kings & (BB_T(1) << turn.to));
+        for (const auto& other : res)
+        {
+            if (other == full)
+                return; // Та же серия, найденная другим путем
+        }
+        res.push_back(full);
+        return;
+    }
+    const auto steps = logic.turns;
+    for (const auto& step : steps)
+    {
+        const bit_move jump = to_bit_move(step);
+        bit_position next = pos;
+        next.do_move(jump);
+        collect_steps(logic, next, bit_move(turn.from, jump.to, turn.captured | jump.captured), was_pawn, res);
+    }
+}
+
+std::vector<bit_move> gen_by_steps(Logic& logic, const bit_position& pos, const bool color)
+{
+    std::vector<bit_move> res;
+    logic.find_turns(color, pos);
+    const auto steps = logic.turns;
+    for (const auto& step : steps)
+    {
+        const bit_move jump = to_bit_move(step);
+        if (!jump.captured)
+        {
+            res.push_back(jump);
+            continue;
+        }
+        bit_position next = pos;
+        next.do_move(jump);
+        collect_steps(logic, next, jump, !(pos.kings & (BB_T(1) << jump.from)), res);
+    }
+    return res;
+}
+
+// Число позиций на глубине depth по ходам Logic::find_turns
+uint64_t perft_steps(Logic& logic, bit_position& pos, const bool color, const int depth)
+{
+    const auto list = gen_by_steps(logic, pos, color);
+    if (depth == 1)
+        return list.size();
+    uint64_t count = 0;
+    for (const auto& turn : list)
+    {
+        const undo_info undo = pos.do_move(turn);
+        count += perft_steps(logic, pos, !color, depth - 1);
+        pos.undo_move(undo);
+    }
+    return count;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: perft <depth> [position] [w|b] [--divide] [--steps]\n"
+                     "       perft --check [max_depth]\n";
+        return 1;
+    }
+
+    if (std::string(argv[1]) == "--check")
+    {
+        const int max_depth = argc > 2 ? std::stoi(argv[2]) : 8;
+        Config config;
+        Logic logic(&config);
+        bool ok = true;
+        for (const auto& test : PERFT_CASES)
+        {
+            bit_position pos;
+            bit_position::from_string(test.position, pos);
+            for (int depth = 1; depth <= max_depth && depth <= int(test.counts.size()); ++depth)
+            {
+                const uint64_t expected = test.counts[depth - 1];
+                const uint64_t count = perft(pos, test.color, depth);
+                // Пошаговый генератор медленнее, поэтому сверяем его на небольших глубинах
+                const bool check_steps = expected < 1000000;
+                const uint64_t by_steps = check_steps ? perft_steps(logic, pos, test.color, depth) : expected;
+                const bool match = count == expected && by_steps == expected;
+                ok = ok && match;
+                std::cout << test.name << " depth " << depth << ": " << count;
+                if (match)
+                    std::cout << " ok\n";
+                else
+                    std::cout << " (steps " << by_steps << ") FAIL, expected " << expected << '\n';
+            }
+        }
+        return ok ? 0 : 2;
+    }
+
+    const int depth = std::stoi(argv[1]);
+    bit_position pos = bit_position::start_position();
+    bool color = false, divide = false, steps = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--divide")
+            divide = true;
+        else if (arg == "--steps")
+            steps = true;
+        else if (arg == "w" || arg == "b")
+            color = arg == "b";
+        else if (!bit_position::from_string(arg, pos))
+        {
+            std::cerr << "Bad position: " << arg << '\n';
+            return 1;
+        }
+    }
+    if (depth < 1)
+    {
+        std::cerr << "Depth must be positive\n";
+        return 1;
+    }
+
+    // Logic нужен только для --steps (читает settings.json, настройки поиска при этом не используются)
+    std::unique_ptr<Config> config;
+    std::unique_ptr<Logic> logic;
+    if (steps)
+    {
+        config = std::make_unique<Config>();
+        logic = std::make_unique<Logic>(config.get());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    if (divide)
+    {
+        std::vector<bit_move> root;
+        if (steps)
+            root = gen_by_steps(*logic, pos, color);
+        else
+        {
+            move_list list;
+            pos.gen_turns(color, list);
+            root.assign(list.begin(), list.end());
+        }
+        for (const auto& turn : root)
+        {
+            uint64_t count = 1;
+            if (depth > 1)
+            {
+                const undo_info undo = pos.do_move(turn);
+                count = steps ? perft_steps(*logic, pos, !color, depth - 1) : perft(pos, !color, depth - 1);
+                pos.undo_move(undo);
+            }
+            std::cout << turn.name() << ": " << count << '\n';
+            total += count;
+        }
+    }
+    else
+        total = steps ? perft_steps(*logic, pos, color, depth) : perft(pos, color, depth);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "nodes: " << total << "\ntime: " << sec * 1000 << " ms\n";
+    if (sec > 0)
+        std::cout << "nodes/sec: " << uint64_t(total / sec) << '\n';
+    return 0;
+}
@@ -0,0 +1,36 @@
+// Генератор базы эндшпиля: ретроградный анализ всех позиций, где фигур не больше max_pieces.
+// Использование: tbgen [max_pieces] [output]
+// По умолчанию строится база до 4 фигур в файл endgame.tb; путь к файлу задается в TablebasePath.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../Game/Tablebase.h"
+
+int main(int argc, char* argv[])
+{
+    const int max_pieces = argc > 1 ? std::stoi(argv[1]) : 4;
+    const std::string out_path = argc > 2 ? argv[2] : "endgame.tb";
+    if (max_pieces < 2 || max_pieces > Tablebase::MAX_GROUP)
+    {
+        std::cerr << "Usage: tbgen [max_pieces (2-" << Tablebase::MAX_GROUP << ")] [output]\n";
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    Tablebase base;
+    base.build(max_pieces, [&](const std::string& name, const uint64_t positions) {
+        total += positions;
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << positions << " positions, " << sec << " s" << std::endl;
+    });
+    if (!base.save(out_path))
+    {
+        std::cerr << "Can't write " << out_path << '\n';
+        return 1;
+    }
+    std::cout << "Total " << total << " positions written to " << out_path << '\n';
+    return 0;
+}